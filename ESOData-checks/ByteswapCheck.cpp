@@ -0,0 +1,67 @@
+#include "CheckSupport.h"
+
+#include <ESOData/Serialization/Byteswap.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <string.h>
+
+using namespace esodata;
+using namespace esodata::checks;
+
+/*
+ * Compares byteswapArray, which uses vector kernels where the CPU has
+ * them, with a plain byte reversal of every element, for each element
+ * width, at every buffer length up to several vector blocks plus a
+ * remainder and at every alignment up to a 32-byte vector. The bytes
+ * around the buffer must be left alone.
+ */
+
+static const size_t MaximumElementCount = 300;
+static const size_t CheckedAlignments = 32;
+static const size_t GuardSize = 64;
+
+int main() {
+	std::mt19937 random(19);
+
+	std::vector<unsigned char> original(GuardSize + CheckedAlignments + MaximumElementCount * 8 + GuardSize);
+	for (auto &byte : original) {
+		byte = static_cast<unsigned char>(random());
+	}
+
+	std::vector<unsigned char> buffer(original.size());
+	std::vector<unsigned char> expected(original.size());
+	size_t checkedBuffers = 0;
+
+	for (size_t width : { 1, 2, 4, 8 }) {
+		for (size_t alignment = 0; alignment < CheckedAlignments; alignment++) {
+			for (size_t count = 0; count <= MaximumElementCount; count++) {
+				auto begin = GuardSize + alignment;
+				auto size = count * width;
+
+				expected = original;
+				for (size_t element = 0; element < count; element++) {
+					auto elementBegin = expected.begin() + begin + element * width;
+					std::reverse(elementBegin, elementBegin + width);
+				}
+
+				buffer = original;
+				byteswapArray(buffer.data() + begin, size, width);
+
+				CHECK(buffer == expected);
+
+				// Swapping twice restores the data.
+				byteswapArray(buffer.data() + begin, size, width);
+				CHECK(buffer == original);
+
+				checkedBuffers++;
+			}
+		}
+	}
+
+	printf("%zu buffers byteswapped as by the scalar reference\n", checkedBuffers);
+
+	return 0;
+}
@@ -0,0 +1,116 @@
+#include "CheckSupport.h"
+
+#include <ESOData/Serialization/CRC32.h>
+
+#include <random>
+#include <vector>
+
+#include <zlib.h>
+
+using namespace esodata;
+using namespace esodata::checks;
+
+/*
+ * Compares the CRC-32 engine with zlib's crc32, bit for bit, for both the
+ * dispatched implementation and the portable slice-by-8 one, then times
+ * all three on a large buffer.
+ */
+
+static uint32_t zlibCRC32(uint32_t crc, const unsigned char *data, size_t dataSize) {
+	return static_cast<uint32_t>(crc32(crc, data, static_cast<uInt>(dataSize)));
+}
+
+static const size_t MaximumCheckedLength = 2000;
+static const size_t CheckedAlignments = 16;
+static const size_t ChainedRuns = 2000;
+static const size_t BenchmarkSize = 64 * 1024 * 1024;
+static const int BenchmarkRounds = 5;
+
+int main() {
+	std::mt19937 random(11);
+
+	std::vector<unsigned char> data(MaximumCheckedLength + CheckedAlignments);
+	for (auto &byte : data) {
+		byte = static_cast<unsigned char>(random());
+	}
+
+	for (size_t alignment = 0; alignment < CheckedAlignments; alignment++) {
+		for (size_t length = 0; length <= MaximumCheckedLength; length++) {
+			auto begin = data.data() + alignment;
+			uint32_t initial = length % 3 == 0 ? 0 : random();
+
+			auto expected = zlibCRC32(initial, begin, length);
+			CHECK(crc32Update(initial, begin, length) == expected);
+			CHECK(crc32UpdatePortable(initial, begin, length) == expected);
+			CHECK(fileCRC32(begin, length) == ~zlibCRC32(0xFFFFFFFFU, begin, length));
+		}
+	}
+
+	// Chained updates over random splits must match a single pass.
+	std::vector<unsigned char> large(1024 * 1024 + 37);
+	for (auto &byte : large) {
+		byte = static_cast<unsigned char>(random());
+	}
+
+	for (size_t run = 0; run < ChainedRuns; run++) {
+		size_t begin = random() % 64;
+		size_t end = large.size() - random() % 64;
+
+		uint32_t crc = 0;
+		uint32_t checksum = 0;
+		for (size_t position = begin; position < end; ) {
+			auto chunk = std::min<size_t>(end - position, random() % (run % 2 == 0 ? 600 : 70000));
+			crc = crc32Update(crc, large.data() + position, chunk);
+			checksum = fileCRC32Update(checksum, large.data() + position, chunk);
+			position += chunk;
+		}
+
+		auto expected = zlibCRC32(0, large.data() + begin, end - begin);
+		CHECK(crc == expected);
+		CHECK(checksum == fileCRC32(large.data() + begin, end - begin));
+		CHECK(checksum == ~zlibCRC32(0xFFFFFFFFU, large.data() + begin, end - begin));
+	}
+
+	printf("CRC-32 matches zlib for lengths 0-%zu at %zu alignments, and over %zu chained runs\n",
+		MaximumCheckedLength, CheckedAlignments, ChainedRuns);
+
+	std::vector<unsigned char> benchmark(BenchmarkSize);
+	for (size_t index = 0; index < benchmark.size(); index++) {
+		benchmark[index] = static_cast<unsigned char>(index * 2654435761U >> 13);
+	}
+
+	struct Candidate {
+		const char *name;
+		uint32_t (*function)(uint32_t crc, const unsigned char *data, size_t dataSize);
+	};
+
+	const Candidate candidates[] = {
+		{ "zlib crc32", zlibCRC32 },
+		{ crc32UsesFolding() ? "crc32Update (folding)" : "crc32Update (slice-by-8)", crc32Update },
+		{ "crc32UpdatePortable", crc32UpdatePortable }
+	};
+
+	uint32_t reference = 0;
+	for (const auto &candidate : candidates) {
+		uint32_t result = 0;
+		double best = 0;
+
+		for (int round = 0; round < BenchmarkRounds; round++) {
+			auto elapsed = measureMilliseconds([&]() {
+				result = candidate.function(0, benchmark.data(), benchmark.size());
+			});
+
+			if (round == 0 || elapsed < best)
+				best = elapsed;
+		}
+
+		if (&candidate == candidates)
+			reference = result;
+
+		CHECK(result == reference);
+
+		printf("%-28s %8.2f ms  %6.2f GB/s\n", candidate.name, best, benchmark.size() / best / 1e6);
+	}
+
+	return 0;
+}
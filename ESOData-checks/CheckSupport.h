@@ -0,0 +1,64 @@
+#ifndef ESODATA_CHECKS_CHECK_SUPPORT_H
+#define ESODATA_CHECKS_CHECK_SUPPORT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <string>
+
+/*
+ * Unlike assert, stays active in release builds, which is where the checks
+ * are most useful to run.
+ */
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			exit(1); \
+		} \
+	} while (0)
+
+namespace esodata {
+	namespace checks {
+		// Empty directory for the files of one check, removed afterwards.
+		class TemporaryDirectory {
+		public:
+			explicit TemporaryDirectory(const std::string &name) {
+				std::random_device device;
+				m_path = std::filesystem::temp_directory_path() / (name + "-" + std::to_string(device()));
+
+				std::filesystem::remove_all(m_path);
+				std::filesystem::create_directories(m_path);
+			}
+
+			~TemporaryDirectory() {
+				std::error_code error;
+				std::filesystem::remove_all(m_path, error);
+			}
+
+			TemporaryDirectory(const TemporaryDirectory &other) = delete;
+			TemporaryDirectory &operator =(const TemporaryDirectory &other) = delete;
+
+			inline const std::filesystem::path &path() const {
+				return m_path;
+			}
+
+		private:
+			std::filesystem::path m_path;
+		};
+
+		template<typename Function>
+		double measureMilliseconds(Function &&function) {
+			auto start = std::chrono::steady_clock::now();
+			function();
+			auto end = std::chrono::steady_clock::now();
+
+			return std::chrono::duration<double, std::milli>(end - start).count();
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,145 @@
+#include "CheckSupport.h"
+#include "SyntheticArchive.h"
+
+#include <ESOData/Filesystem/Filesystem.h>
+
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace esodata;
+using namespace esodata::checks;
+
+/*
+ * Stress test of the Filesystem concurrency contract: once set up, a single
+ * Filesystem is read from 32 threads at once, every thread reading every
+ * key, and the checksum of everything read is compared with the manifest.
+ * Some of the reads are small readFilesByKeys batches, which all decode on
+ * the shared worker pool.
+ */
+
+static const size_t ThreadCount = 32;
+static const size_t BatchSize = 4;
+
+static const char *backendName(ArchiveIOBackend backend) {
+	switch (backend) {
+	case ArchiveIOBackend::Synchronous:
+		return "Synchronous";
+
+	case ArchiveIOBackend::MemoryMapped:
+		return "MemoryMapped";
+
+	default:
+		return "other";
+	}
+}
+
+static size_t readAllKeysConcurrently(const Filesystem &fs, const std::vector<SyntheticFile> &files) {
+	std::atomic<size_t> mismatches(0);
+	std::atomic<size_t> ready(0);
+
+	std::unordered_map<uint64_t, uint32_t> expectedByKey;
+	for (const auto &file : files) {
+		expectedByKey.emplace(file.key, expectedFileCRC32(file.data));
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve(ThreadCount);
+
+	for (size_t threadIndex = 0; threadIndex < ThreadCount; threadIndex++) {
+		threads.emplace_back([&, threadIndex]() {
+			// Start all threads together, so that their reads overlap.
+			ready++;
+			while (ready.load() != ThreadCount)
+				std::this_thread::yield();
+
+			std::vector<unsigned char> buffer;
+
+			for (size_t step = 0; step < files.size(); step++) {
+				// Each thread starts at a different file, and goes through the read APIs in turn.
+				auto index = (step + threadIndex * files.size() / ThreadCount) % files.size();
+				const auto &file = files[index];
+				auto expected = expectedFileCRC32(file.data);
+
+				uint32_t checksum;
+				switch ((step + threadIndex) % 4) {
+				case 0:
+					buffer = fs.readFileByKey(file.key);
+					checksum = expectedFileCRC32(buffer);
+					break;
+
+				case 1:
+				{
+					buffer.resize(fs.fileSize(file.key));
+					auto size = fs.readFileInto(file.key, buffer.data(), buffer.size());
+					checksum = expectedFileCRC32(buffer.data(), size);
+					break;
+				}
+
+				case 2:
+				{
+					auto view = fs.viewFileByKey(file.key);
+					checksum = expectedFileCRC32(view.data(), view.size());
+					break;
+				}
+
+				default:
+				{
+					// The file and the ones following it, checked as they arrive.
+					std::vector<uint64_t> keys;
+					for (size_t batch = 0; batch < BatchSize; batch++) {
+						keys.push_back(files[(index + batch) % files.size()].key);
+					}
+
+					checksum = expected;
+					fs.readFilesByKeys(keys, [&](uint64_t key, std::vector<unsigned char> &data) {
+						if (expectedFileCRC32(data) != expectedByKey.at(key))
+							checksum = ~expected;
+					});
+					break;
+				}
+				}
+
+				if (checksum != expected)
+					mismatches++;
+			}
+		});
+	}
+
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	return mismatches;
+}
+
+int main() {
+	TemporaryDirectory directory("ESOData-ConcurrentReadsCheck");
+
+	auto files = makeRandomFiles(0x100, 400, 3, 128 * 1024);
+	writeSyntheticArchive(directory.path(), "game", files, 3);
+
+	for (auto backend : { ArchiveIOBackend::Synchronous, ArchiveIOBackend::MemoryMapped }) {
+		for (bool cached : { false, true }) {
+			Filesystem fs;
+			fs.setArchiveIOBackend(backend);
+			if (cached)
+				fs.setCacheBudget(8 * 1024 * 1024, 4 * 1024 * 1024);
+
+			fs.addManifest(directory.path() / "game.mnf", false);
+
+			size_t mismatches;
+			auto elapsed = measureMilliseconds([&]() {
+				mismatches = readAllKeysConcurrently(fs, files);
+			});
+
+			printf("%s%s: %zu threads x %zu files in %.1f ms, %zu checksum mismatches\n",
+				backendName(backend), cached ? " (cached)" : "", ThreadCount, files.size(), elapsed, mismatches);
+
+			CHECK(mismatches == 0);
+		}
+	}
+
+	return 0;
+}
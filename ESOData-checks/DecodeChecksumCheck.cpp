@@ -0,0 +1,162 @@
+#include "CheckSupport.h"
+#include "SyntheticArchive.h"
+
+#include <ESOData/Filesystem/Codec.h>
+#include <ESOData/Filesystem/Filesystem.h>
+#include <ESOData/Serialization/CRC32.h>
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace esodata;
+using namespace esodata::checks;
+
+/*
+ * Compares Codec::decodeAndChecksum, which checksums the output while it
+ * is decoded, with decode followed by fileCRC32, for the Deflate and
+ * Snappy codecs. Then damages stored entries of a synthetic archive, so
+ * that only their checksum can tell, and expects every read path to
+ * report a CRC32 mismatch for them while the other entries read back.
+ */
+
+static const size_t DataSetCount = 400;
+
+static void checkCodec(const Codec &codec, FileCompressionType compressionType, std::mt19937 &random) {
+	for (size_t dataSet = 0; dataSet < DataSetCount; dataSet++) {
+		size_t size;
+		if (dataSet % 40 == 0)
+			size = random() % (4 * 1024 * 1024);
+		else
+			size = random() % (dataSet % 2 == 0 ? 300 : 200000);
+
+		std::vector<unsigned char> data(size);
+		for (size_t position = 0; position < size; position++) {
+			data[position] = static_cast<unsigned char>((position / 11) ^ (random() % 5));
+		}
+
+		auto compressed = compressForArchive(data, compressionType);
+
+		std::vector<unsigned char> fused(size);
+		auto checksum = codec.decodeAndChecksum(compressed.data(), compressed.size(), fused.data(), fused.size());
+
+		std::vector<unsigned char> separate(size);
+		codec.decode(compressed.data(), compressed.size(), separate.data(), separate.size());
+
+		CHECK(fused == data);
+		CHECK(separate == data);
+		CHECK(checksum == fileCRC32(separate.data(), separate.size()));
+		CHECK(checksum == expectedFileCRC32(data));
+	}
+}
+
+int main() {
+	std::mt19937 random(23);
+
+	auto &registry = CodecRegistry::instance();
+	checkCodec(registry.require(CodecId::Deflate), FileCompressionType::Deflate, random);
+	checkCodec(registry.require(CodecId::Snappy), FileCompressionType::Snappy, random);
+
+	printf("decodeAndChecksum matches decode and fileCRC32\n");
+
+	TemporaryDirectory directory("ESOData-DecodeChecksumCheck");
+
+	auto files = makeRandomFiles(0x100, 300, 23, 96 * 1024);
+	writeSyntheticArchive(directory.path(), "game", files);
+
+	/*
+	 * Every other non-empty stored entry gets a byte flipped in the data
+	 * file. Stored entries are copied as is, so nothing but the checksum
+	 * catches that.
+	 */
+	std::vector<bool> damaged(files.size(), false);
+	{
+		std::fstream dataFile(directory.path() / "game0000.dat", std::ios::in | std::ios::out | std::ios::binary);
+		dataFile.exceptions(std::ios::failbit | std::ios::badbit);
+
+		uint64_t offset = 14;
+		size_t storedCount = 0;
+
+		for (size_t index = 0; index < files.size(); index++) {
+			const auto &file = files[index];
+			auto compressedSize = compressForArchive(file.data, file.compressionType).size();
+
+			if (file.compressionType == FileCompressionType::None && !file.data.empty() && storedCount++ % 2 == 0) {
+				auto position = offset + random() % compressedSize;
+
+				dataFile.seekg(position);
+				char byte;
+				dataFile.read(&byte, 1);
+
+				byte ^= 0x20;
+				dataFile.seekp(position);
+				dataFile.write(&byte, 1);
+
+				damaged[index] = true;
+			}
+
+			// writeSyntheticArchive leaves 7 bytes between files.
+			offset += compressedSize + 7;
+		}
+	}
+
+	for (auto backend : { ArchiveIOBackend::Synchronous, ArchiveIOBackend::MemoryMapped }) {
+		Filesystem fs;
+		fs.setArchiveIOBackend(backend);
+		fs.addManifest(directory.path() / "game.mnf", false);
+
+		std::vector<unsigned char> buffer;
+
+		for (size_t index = 0; index < files.size(); index++) {
+			const auto &file = files[index];
+
+			for (int readPath = 0; readPath < 3; readPath++) {
+				try {
+					switch (readPath) {
+					case 0:
+						buffer = fs.readFileByKey(file.key);
+						break;
+
+					case 1:
+						buffer.resize(fs.fileSize(file.key));
+						buffer.resize(fs.readFileInto(file.key, buffer.data(), buffer.size()));
+						break;
+
+					default:
+					{
+						auto view = fs.viewFileByKey(file.key);
+						buffer.assign(view.data(), view.data() + view.size());
+						break;
+					}
+					}
+
+					CHECK(!damaged[index]);
+					CHECK(buffer == file.data);
+				}
+				catch (const std::runtime_error &error) {
+					CHECK(damaged[index]);
+					CHECK(std::string(error.what()).find("CRC32 mismatch") != std::string::npos);
+				}
+			}
+		}
+
+		std::vector<uint64_t> keys;
+		std::vector<uint64_t> damagedKeys;
+		for (size_t index = 0; index < files.size(); index++) {
+			keys.push_back(files[index].key);
+			if (damaged[index])
+				damagedKeys.push_back(files[index].key);
+		}
+
+		auto failed = fs.verifyFiles(keys);
+		std::sort(failed.begin(), failed.end());
+		CHECK(failed == damagedKeys);
+	}
+
+	printf("damaged stored entries fail with a CRC32 mismatch on every read path\n");
+
+	return 0;
+}
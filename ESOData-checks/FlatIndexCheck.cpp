@@ -0,0 +1,218 @@
+#include "CheckSupport.h"
+
+#include <ESOData/Filesystem/FlatIndex.h>
+#include <ESOData/Filesystem/ManifestFileEntry.h>
+
+#include <ESOData/Serialization/InputSerializationStream.h>
+#include <ESOData/Serialization/OutputSerializationStream.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <string.h>
+
+using namespace esodata;
+using namespace esodata::checks;
+
+/*
+ * Compares FlatIndex with std::unordered_map over random, sequential and
+ * clustered keys, including 0 and ~0, the key that marks empty slots and
+ * is kept aside. Duplicate insertions must keep the first value; find,
+ * findMany and enumerate must agree with the map after every round of
+ * insertions, through several rehashes. The final index must also read
+ * back from writeRaw output, both in place and copied, and reject output
+ * with inconsistent counts.
+ */
+
+static const size_t RoundCount = 12;
+static const size_t InsertionsPerRound = 5000;
+
+static uint64_t makeKey(std::mt19937_64 &random, size_t index) {
+	switch (random() % 4) {
+	case 0:
+		return index;
+
+	case 1:
+		// Keys differing only in their high bits.
+		return static_cast<uint64_t>(index) << 40;
+
+	case 2:
+		return ~static_cast<uint64_t>(0) - random() % 64;
+
+	default:
+		return random();
+	}
+}
+
+template<typename Value>
+static void checkRawRoundTrip(const FlatIndex<Value> &index, const std::unordered_map<uint64_t, Value> &reference) {
+	OutputSerializationStream output;
+	index.writeRaw(output);
+	auto written = output.data();
+
+	// Slots are aligned relative to the start of the data, which readRaw expects to be aligned too.
+	auto storage = std::make_shared<std::vector<unsigned char>>(written.size() + 64);
+	auto begin = storage->data() + (64 - reinterpret_cast<uintptr_t>(storage->data()) % 64) % 64;
+	memcpy(begin, written.data(), written.size());
+
+	uint64_t probeKey = reference.begin()->first;
+	if (probeKey == ~static_cast<uint64_t>(0))
+		probeKey = std::next(reference.begin())->first;
+
+	for (bool inPlace : { true, false }) {
+		FlatIndex<Value> loaded;
+		InputSerializationStream input(begin, begin + written.size());
+		loaded.readRaw(input, inPlace ? std::shared_ptr<const void>(storage) : std::shared_ptr<const void>());
+		CHECK(input.getCurrentPosition() == written.size());
+		CHECK(loaded.size() == reference.size());
+
+		for (const auto &entry : reference) {
+			auto found = loaded.find(entry.first);
+			CHECK(found && memcmp(found, &entry.second, sizeof(Value)) == 0);
+		}
+
+		auto probe = reinterpret_cast<const unsigned char *>(loaded.find(probeKey));
+		CHECK((probe >= begin && probe < begin + written.size()) == inPlace);
+
+		// Inserting copies the slots out of the storage first.
+		uint64_t newKey = 1;
+		while (reference.count(newKey) != 0)
+			newKey++;
+
+		CHECK(loaded.insert(newKey, Value()));
+		CHECK(loaded.size() == reference.size() + 1);
+
+		probe = reinterpret_cast<const unsigned char *>(loaded.find(probeKey));
+		CHECK(probe < begin || probe >= begin + written.size());
+		CHECK(memcmp(probe, &reference.at(probeKey), sizeof(Value)) == 0);
+	}
+
+	// The entry count, then the capacity, lead the output.
+	for (size_t offset : { static_cast<size_t>(0), sizeof(uint64_t) }) {
+		auto damaged = written;
+		damaged[offset] ^= 1;
+
+		FlatIndex<Value> loaded;
+		InputSerializationStream input(damaged.data(), damaged.data() + damaged.size());
+
+		bool rejected = false;
+		try {
+			loaded.readRaw(input, nullptr);
+		}
+		catch (const std::logic_error &) {
+			rejected = true;
+		}
+
+		CHECK(rejected);
+	}
+}
+
+template<typename Value, typename MakeValue>
+static void compareWithMap(std::mt19937_64 &random, MakeValue &&makeValue, bool reserveFirst) {
+	FlatIndex<Value> index;
+	std::unordered_map<uint64_t, Value> reference;
+
+	if (reserveFirst)
+		index.reserve(RoundCount * InsertionsPerRound / 2);
+
+	std::vector<uint64_t> probes;
+	std::vector<const Value *> results;
+
+	for (size_t round = 0; round < RoundCount; round++) {
+		for (size_t insertion = 0; insertion < InsertionsPerRound; insertion++) {
+			uint64_t key;
+			if (insertion == 0)
+				key = round % 2 == 0 ? ~static_cast<uint64_t>(0) : 0;
+			else
+				key = makeKey(random, round * InsertionsPerRound + insertion);
+
+			auto value = makeValue(random);
+			bool inserted = reference.emplace(key, value).second;
+			CHECK(index.insert(key, value) == inserted);
+		}
+
+		CHECK(index.size() == reference.size());
+
+		probes.clear();
+		for (const auto &entry : reference) {
+			auto found = index.find(entry.first);
+			CHECK(found && memcmp(found, &entry.second, sizeof(Value)) == 0);
+
+			probes.push_back(entry.first);
+		}
+
+		// Absent keys, mixed in with present ones for findMany.
+		for (size_t absent = 0; absent < InsertionsPerRound; absent++) {
+			auto key = makeKey(random, random() % (2 * RoundCount * InsertionsPerRound));
+			auto expected = reference.find(key);
+			auto found = index.find(key);
+
+			if (expected == reference.end())
+				CHECK(found == nullptr);
+			else
+				CHECK(found && memcmp(found, &expected->second, sizeof(Value)) == 0);
+
+			probes.push_back(key);
+		}
+
+		std::shuffle(probes.begin(), probes.end(), random);
+
+		results.assign(probes.size(), nullptr);
+		index.findMany(probes.data(), probes.size(), results.data());
+		for (size_t probe = 0; probe < probes.size(); probe++) {
+			CHECK(results[probe] == index.find(probes[probe]));
+		}
+
+		size_t enumerated = 0;
+		index.enumerate([&](uint64_t key, const Value &value) {
+			auto expected = reference.find(key);
+			CHECK(expected != reference.end());
+			CHECK(memcmp(&value, &expected->second, sizeof(Value)) == 0);
+			enumerated++;
+		});
+
+		CHECK(enumerated == reference.size());
+	}
+
+	checkRawRoundTrip(index, reference);
+}
+
+int main() {
+	std::mt19937_64 random(16);
+
+	// An empty index finds nothing, including the empty slot key.
+	FlatIndex<uint32_t> empty;
+	CHECK(empty.find(0) == nullptr);
+	CHECK(empty.find(~static_cast<uint64_t>(0)) == nullptr);
+
+	uint64_t emptyProbes[] = { 0, 1, ~static_cast<uint64_t>(0) };
+	uint32_t sentinel = 0;
+	const uint32_t *emptyResults[3] = { &sentinel, &sentinel, &sentinel };
+	empty.findMany(emptyProbes, 3, emptyResults);
+	CHECK(emptyResults[0] == nullptr && emptyResults[1] == nullptr && emptyResults[2] == nullptr);
+
+	for (bool reserveFirst : { false, true }) {
+		compareWithMap<uint32_t>(random, [](std::mt19937_64 &random) {
+			return static_cast<uint32_t>(random());
+		}, reserveFirst);
+
+		compareWithMap<ManifestFileEntry>(random, [](std::mt19937_64 &random) {
+			ManifestFileEntry entry = {};
+			entry.uncompressedSize = static_cast<uint32_t>(random());
+			entry.compressedSize = static_cast<uint32_t>(random());
+			entry.fileCRC32 = static_cast<uint32_t>(random());
+			entry.fileOffset = static_cast<uint32_t>(random());
+			entry.compressionType = static_cast<FileCompressionType>(random() % 3);
+			entry.archiveIndex = static_cast<uint8_t>(random());
+			return entry;
+		}, reserveFirst);
+	}
+
+	printf("FlatIndex agrees with std::unordered_map\n");
+
+	return 0;
+}
@@ -0,0 +1,367 @@
+#include "CheckSupport.h"
+
+#include <ESOData/Filesystem/FileTable.h>
+#include <ESOData/Filesystem/ManifestFileEntry.h>
+#include <ESOData/Serialization/DeflatedSegment.h>
+#include <ESOData/Serialization/HashTable.h>
+#include <ESOData/Serialization/InputSerializationStream.h>
+#include <ESOData/Serialization/OutputSerializationStream.h>
+#include <ESOData/Serialization/SizedVector.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <string.h>
+
+using namespace esodata;
+using namespace esodata::checks;
+
+/*
+ * Compares hash tables whose segments are decoded together through a
+ * DeflatedSegmentBatch with the same tables read one segment at a time,
+ * as they were before batching. Several tables of different key and value
+ * types share a batch, with other fields read in between, in both byte
+ * orders. A whole ZOSFT file table is read the same way. A damaged
+ * segment must make the batch throw.
+ */
+
+static const size_t TablesPerRound = 8;
+static const size_t RoundCount = 4;
+
+static uint32_t randomValue(std::mt19937 &random, uint32_t *) {
+	return static_cast<uint32_t>(random());
+}
+
+static uint64_t randomValue(std::mt19937 &random, uint64_t *) {
+	return (static_cast<uint64_t>(random()) << 32) | random();
+}
+
+static FileTableEntry randomValue(std::mt19937 &random, FileTableEntry *) {
+	auto localFileKey = randomValue(random, static_cast<uint32_t *>(nullptr));
+	auto nameOffset = randomValue(random, static_cast<uint32_t *>(nullptr));
+
+	return FileTableEntry{ localFileKey, nameOffset, randomValue(random, static_cast<uint64_t *>(nullptr)) };
+}
+
+static FileTableAdditionalData randomValue(std::mt19937 &random, FileTableAdditionalData *) {
+	FileTableAdditionalData data;
+	for (auto &value : data.unknown1) {
+		value = random();
+	}
+
+	return data;
+}
+
+static ManifestFileEntry randomValue(std::mt19937 &random, ManifestFileEntry *) {
+	ManifestFileEntry entry = {};
+	entry.uncompressedSize = random();
+	entry.compressedSize = random();
+	entry.fileCRC32 = random();
+	entry.fileOffset = random();
+	entry.compressionType = static_cast<FileCompressionType>(random() % 3);
+	entry.archiveIndex = static_cast<uint8_t>(random());
+	entry.unknown = static_cast<uint16_t>(random());
+	return entry;
+}
+
+template<typename T>
+static bool sameValue(const T &first, const T &second) {
+	return memcmp(&first, &second, sizeof(T)) == 0;
+}
+
+// The cached size isn't part of the serialized entry.
+static bool sameValue(const ManifestFileEntry &first, const ManifestFileEntry &second) {
+	return first.uncompressedSize == second.uncompressedSize &&
+		first.compressedSize == second.compressedSize &&
+		first.fileCRC32 == second.fileCRC32 &&
+		first.fileOffset == second.fileOffset &&
+		first.compressionType == second.compressionType &&
+		first.archiveIndex == second.archiveIndex &&
+		first.unknown == second.unknown;
+}
+
+template<typename T>
+static bool sameValues(const std::vector<T> &first, const std::vector<T> &second) {
+	if (first.size() != second.size())
+		return false;
+
+	for (size_t index = 0; index < first.size(); index++) {
+		if (!sameValue(first[index], second[index]))
+			return false;
+	}
+
+	return true;
+}
+
+// A table as written by the game: buckets probed linearly from the hash of the key.
+template<typename Key, typename Value>
+static HashTableType3Data<Key, Value> makeTable(std::mt19937 &random, size_t count) {
+	HashTableType3Data<Key, Value> table;
+	table.hashTable.resize(count == 0 ? 0 : count * 2 + 1);
+
+	for (size_t index = 0; index < count; index++) {
+		auto key = static_cast<Key>(randomValue(random, static_cast<Key *>(nullptr)));
+		table.keys.push_back(key);
+		table.values.push_back(randomValue(random, static_cast<Value *>(nullptr)));
+
+		auto bucket = hashData64(reinterpret_cast<const unsigned char *>(&key), sizeof(key)) % table.hashTable.size();
+		while (table.hashTable[bucket] != 0)
+			bucket = (bucket + 1) % table.hashTable.size();
+
+		table.hashTable[bucket] = 0x80000000U | static_cast<uint32_t>(index);
+	}
+
+	return table;
+}
+
+// Reads a table the way it was read before segments were batched.
+template<typename Key, typename Value>
+static void readTableSerially(SerializationStream &stream, HashTableType3Data<Key, Value> &data) {
+	uint16_t tableType;
+	uint32_t countLength;
+	uint32_t hashTableCount;
+	uint32_t keyCount;
+	uint32_t valueCount;
+
+	stream >> tableType >> countLength >> hashTableCount >> keyCount >> valueCount;
+	CHECK(tableType == 3 && countLength == 4);
+
+	auto pairCount = std::max(keyCount, valueCount);
+	data.hashTable.resize(hashTableCount);
+	data.keys.resize(pairCount);
+	data.values.resize(pairCount);
+
+	if (hashTableCount != 0)
+		stream >> makeDeflatedSegment<std::vector<uint32_t>, ByteswapMode::Disable>(data.hashTable);
+
+	if (pairCount != 0) {
+		stream >> makeDeflatedSegment<std::vector<Key>, ByteswapMode::Disable>(data.keys);
+		stream >> makeDeflatedSegment<std::vector<Value>, ByteswapMode::Disable>(data.values);
+	}
+}
+
+template<typename Key, typename Value>
+static void readTableBatched(SerializationStream &stream, HashTableType3Data<Key, Value> &data, DeflatedSegmentBatch &batch) {
+	uint16_t tableType;
+	stream >> tableType;
+	CHECK(tableType == 3);
+
+	readHashTableData(stream, data, batch);
+}
+
+template<typename Key, typename Value>
+static void checkSame(const HashTableType3Data<Key, Value> &expected, const HashTableType3Data<Key, Value> &serial, const HashTableType3Data<Key, Value> &batched) {
+	CHECK(serial.hashTable == expected.hashTable && batched.hashTable == expected.hashTable);
+	CHECK(sameValues(serial.keys, expected.keys) && sameValues(batched.keys, expected.keys));
+	CHECK(sameValues(serial.values, expected.values) && sameValues(batched.values, expected.values));
+}
+
+/*
+ * One round: tables of every type, each followed by a marker, read back
+ * serially and through one batch.
+ */
+struct TableSet {
+	std::vector<HashTableType3Data<uint64_t, uint32_t>> nameHashes;
+	std::vector<HashTableType3Data<uint32_t, FileTableEntry>> entries;
+	std::vector<HashTableType3Data<uint32_t, FileTableAdditionalData>> additionalData;
+	std::vector<HashTableType3Data<uint64_t, ManifestFileEntry>> manifestEntries;
+};
+
+template<typename Function>
+static void forEachTable(TableSet &set, size_t index, Function &&function) {
+	switch (index % 4) {
+	case 0:
+		function(set.nameHashes[index / 4]);
+		break;
+
+	case 1:
+		function(set.entries[index / 4]);
+		break;
+
+	case 2:
+		function(set.additionalData[index / 4]);
+		break;
+
+	default:
+		function(set.manifestEntries[index / 4]);
+		break;
+	}
+}
+
+static void checkRound(std::mt19937 &random, bool swapEndian) {
+	TableSet expected;
+	for (size_t index = 0; index < TablesPerRound; index++) {
+		size_t count = index == 0 ? 0 : random() % (index % 2 == 0 ? 20000 : 50);
+
+		switch (index % 4) {
+		case 0:
+			expected.nameHashes.push_back(makeTable<uint64_t, uint32_t>(random, count));
+			break;
+
+		case 1:
+			expected.entries.push_back(makeTable<uint32_t, FileTableEntry>(random, count));
+			break;
+
+		case 2:
+			expected.additionalData.push_back(makeTable<uint32_t, FileTableAdditionalData>(random, count));
+			break;
+
+		default:
+			expected.manifestEntries.push_back(makeTable<uint64_t, ManifestFileEntry>(random, count));
+			break;
+		}
+	}
+
+	OutputSerializationStream output;
+	output.setSwapEndian(swapEndian);
+	for (size_t index = 0; index < TablesPerRound; index++) {
+		forEachTable(expected, index, [&](const auto &table) {
+			output << static_cast<uint16_t>(3) << table;
+		});
+
+		output << static_cast<uint32_t>(0xC0DE0000U + index);
+	}
+
+	auto data = output.data();
+
+	TableSet serial = expected;
+	TableSet batched = expected;
+
+	{
+		InputSerializationStream stream(data.data(), data.data() + data.size());
+		stream.setSwapEndian(swapEndian);
+
+		for (size_t index = 0; index < TablesPerRound; index++) {
+			forEachTable(serial, index, [&](auto &table) {
+				table = {};
+				readTableSerially(stream, table);
+			});
+
+			uint32_t marker;
+			stream >> marker;
+			CHECK(marker == 0xC0DE0000U + index);
+		}
+	}
+
+	{
+		InputSerializationStream stream(data.data(), data.data() + data.size());
+		stream.setSwapEndian(swapEndian);
+
+		DeflatedSegmentBatch batch;
+		for (size_t index = 0; index < TablesPerRound; index++) {
+			forEachTable(batched, index, [&](auto &table) {
+				table = {};
+				readTableBatched(stream, table, batch);
+			});
+
+			uint32_t marker;
+			stream >> marker;
+			CHECK(marker == 0xC0DE0000U + index);
+		}
+
+		batch.decode();
+	}
+
+	for (size_t index = 0; index < TablesPerRound / 4; index++) {
+		checkSame(expected.nameHashes[index], serial.nameHashes[index], batched.nameHashes[index]);
+		checkSame(expected.entries[index], serial.entries[index], batched.entries[index]);
+		checkSame(expected.additionalData[index], serial.additionalData[index], batched.additionalData[index]);
+		checkSame(expected.manifestEntries[index], serial.manifestEntries[index], batched.manifestEntries[index]);
+	}
+
+	// Damaging the compressed data of one segment makes the whole batch fail.
+	auto damaged = data;
+	damaged[damaged.size() / 2] ^= 0x55;
+
+	InputSerializationStream stream(damaged.data(), damaged.data() + damaged.size());
+	stream.setSwapEndian(swapEndian);
+
+	bool threw = false;
+	try {
+		DeflatedSegmentBatch batch;
+		for (size_t index = 0; index < TablesPerRound; index++) {
+			forEachTable(batched, index, [&](auto &table) {
+				readTableBatched(stream, table, batch);
+			});
+
+			uint32_t marker;
+			stream >> marker;
+		}
+
+		batch.decode();
+	}
+	catch (const std::exception &) {
+		threw = true;
+	}
+
+	CHECK(threw);
+}
+
+template<typename Key, typename Value>
+static void checkHashTable(const HashTable<Key, Value> &table, const HashTableType3Data<Key, Value> &expected) {
+	size_t count = 0;
+	for (auto it = table.begin(); it != table.end(); ++it) {
+		count++;
+	}
+
+	CHECK(count == expected.keys.size());
+
+	for (size_t index = 0; index < expected.keys.size(); index++) {
+		auto it = table.find(expected.keys[index]);
+		CHECK(it != table.end());
+		CHECK(sameValue((*it).second, expected.values[index]));
+	}
+}
+
+static void checkFileTable(std::mt19937 &random) {
+	auto nameHashes = makeTable<uint64_t, uint32_t>(random, 30000);
+	auto entries = makeTable<uint32_t, FileTableEntry>(random, 30000);
+	auto additionalData = makeTable<uint32_t, FileTableAdditionalData>(random, 500);
+
+	std::vector<char> nameHeap(100000);
+	for (auto &character : nameHeap) {
+		character = static_cast<char>('a' + random() % 26);
+	}
+
+	static const std::array<unsigned char, 5> Signature{ 'Z', 'O', 'S', 'F', 'T' };
+
+	OutputSerializationStream output;
+	output.setSwapEndian(true);
+	output << Signature << static_cast<uint16_t>(1) << static_cast<uint32_t>(2) << static_cast<uint32_t>(3) << static_cast<uint32_t>(30000);
+	output << static_cast<uint16_t>(3) << nameHashes;
+	output << static_cast<uint16_t>(3) << entries;
+	output << static_cast<uint16_t>(3) << additionalData;
+	output << makeSizedVector<uint32_t>(nameHeap) << Signature;
+
+	auto data = output.data();
+
+	InputSerializationStream stream(data.data(), data.data() + data.size());
+	stream.setSwapEndian(true);
+
+	FileTable table;
+	stream >> table;
+
+	CHECK(table.recordCount == 30000);
+	CHECK(table.nameHeap == nameHeap);
+
+	checkHashTable(table.nameHashToLocalId, nameHashes);
+	checkHashTable(table.entries, entries);
+	checkHashTable(table.additionalData, additionalData);
+}
+
+int main() {
+	std::mt19937 random(22);
+
+	for (size_t round = 0; round < RoundCount; round++) {
+		checkRound(random, round % 2 == 0);
+	}
+
+	checkFileTable(random);
+
+	printf("batched hash table segments match serial parsing\n");
+
+	return 0;
+}
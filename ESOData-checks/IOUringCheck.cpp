@@ -0,0 +1,164 @@
+#include "CheckSupport.h"
+#include "SyntheticArchive.h"
+
+#include <ESOData/Filesystem/ArchiveDataFile.h>
+#include <ESOData/Filesystem/Filesystem.h>
+#include <ESOData/Filesystem/IOUringArchiveDataFile.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <string.h>
+
+using namespace esodata;
+using namespace esodata::checks;
+
+/*
+ * Compares batched reads through the IOUring backend with the contents of
+ * the file and with the serial reads of the Synchronous backend, which
+ * are also what the IOUring backend falls back to. Batch sizes cover the
+ * single request batches that are always read serially, batches whose
+ * buffers are registered with the ring, and batches too large for that.
+ * Then reads a synthetic archive through Filesystem::readFilesByKeys with
+ * both backends.
+ *
+ * Where io_uring is unavailable, the IOUring backend is the Synchronous
+ * fallback, and the same results are expected.
+ */
+
+static const size_t DataFileSize = 4 * 1024 * 1024;
+static const size_t BatchSizes[] = { 1, 2, 7, 64, 256, 257, 1024, 1500 };
+
+static std::vector<ArchiveReadRequest> makeRequests(std::mt19937 &random, size_t count, std::vector<std::vector<unsigned char>> &buffers) {
+	buffers.resize(count);
+
+	std::vector<ArchiveReadRequest> requests(count);
+	for (size_t index = 0; index < count; index++) {
+		uint64_t offset = random() % DataFileSize;
+
+		// Some empty reads, some reaching the end of the file, and mostly small and medium ones.
+		size_t size;
+		switch (random() % 8) {
+		case 0:
+			size = 0;
+			break;
+
+		case 1:
+			size = static_cast<size_t>(DataFileSize - offset);
+			break;
+
+		default:
+			size = std::min<size_t>(DataFileSize - offset, random() % (random() % 4 == 0 ? 1024 * 1024 : 8192));
+			break;
+		}
+
+		buffers[index].assign(size, 0xCD);
+		requests[index] = ArchiveReadRequest{ offset, buffers[index].data(), size };
+	}
+
+	return requests;
+}
+
+static void checkBatch(const ArchiveDataFile &file, const std::vector<unsigned char> &contents, std::mt19937 &random, size_t count) {
+	std::vector<std::vector<unsigned char>> buffers;
+	auto requests = makeRequests(random, count, buffers);
+
+	std::vector<size_t> completions(requests.size(), 0);
+	file.readBatch(requests, [&](size_t index) {
+		CHECK(index < requests.size());
+		completions[index]++;
+
+		const auto &request = requests[index];
+		CHECK(request.size == 0 || memcmp(request.data, contents.data() + request.offset, request.size) == 0);
+	});
+
+	for (auto completionCount : completions) {
+		CHECK(completionCount == 1);
+	}
+}
+
+int main() {
+	printf("io_uring supported: %s\n", IOUringArchiveDataFile::isSupported() ? "yes" : "no, checking the fallback");
+
+	std::mt19937 random(14);
+
+	TemporaryDirectory directory("ESOData-IOUringCheck");
+
+	std::vector<unsigned char> contents(DataFileSize);
+	for (auto &byte : contents) {
+		byte = static_cast<unsigned char>(random());
+	}
+
+	auto dataFilename = directory.path() / "data.dat";
+	writeWholeFile(dataFilename, contents);
+
+	auto ring = ArchiveDataFile::open(dataFilename, ArchiveIOBackend::IOUring);
+	auto serial = ArchiveDataFile::open(dataFilename, ArchiveIOBackend::Synchronous);
+
+	for (auto count : BatchSizes) {
+		for (int round = 0; round < 2; round++) {
+			checkBatch(*ring, contents, random, count);
+			checkBatch(*serial, contents, random, count);
+		}
+	}
+
+	// A failing read throws, after the other reads of the batch have landed.
+	for (auto file : { ring.get(), serial.get() }) {
+		std::vector<std::vector<unsigned char>> buffers;
+		auto requests = makeRequests(random, 100, buffers);
+
+		std::vector<unsigned char> pastEnd(100);
+		requests.insert(requests.begin() + 50, ArchiveReadRequest{ DataFileSize - 10, pastEnd.data(), pastEnd.size() });
+
+		bool threw = false;
+		try {
+			file->readBatch(requests, [](size_t) {});
+		}
+		catch (const std::exception &) {
+			threw = true;
+		}
+
+		CHECK(threw);
+	}
+
+	printf("batched reads match the file for batches of up to %zu reads\n", BatchSizes[sizeof(BatchSizes) / sizeof(BatchSizes[0]) - 1]);
+
+	auto files = makeRandomFiles(0x100, 1500, 14, 96 * 1024);
+	writeSyntheticArchive(directory.path(), "game", files, 3);
+
+	std::map<uint64_t, const SyntheticFile *> filesByKey;
+	std::vector<uint64_t> keys;
+	for (const auto &file : files) {
+		filesByKey.emplace(file.key, &file);
+		keys.push_back(file.key);
+	}
+
+	// Missing keys are skipped.
+	keys.push_back(1);
+
+	for (auto backend : { ArchiveIOBackend::IOUring, ArchiveIOBackend::Synchronous }) {
+		Filesystem fs;
+		fs.setArchiveIOBackend(backend);
+		fs.addManifest(directory.path() / "game.mnf", false);
+
+		std::map<uint64_t, size_t> seen;
+		fs.readFilesByKeys(keys, [&](uint64_t key, std::vector<unsigned char> &data) {
+			auto it = filesByKey.find(key);
+			CHECK(it != filesByKey.end());
+			CHECK(data == it->second->data);
+			seen[key]++;
+		});
+
+		CHECK(seen.size() == files.size());
+		for (const auto &entry : seen) {
+			CHECK(entry.second == 1);
+		}
+	}
+
+	printf("readFilesByKeys reads %zu files identically through both backends\n", files.size());
+
+	return 0;
+}
@@ -0,0 +1,312 @@
+#include "CheckSupport.h"
+#include "SyntheticArchive.h"
+
+#include <ESOData/Filesystem/FileTable.h>
+#include <ESOData/Filesystem/Filesystem.h>
+#include <ESOData/Filesystem/IndexSnapshot.h>
+#include <ESOData/IO/IOUtilities.h>
+#include <ESOData/Serialization/Hash.h>
+#include <ESOData/Serialization/InputSerializationStream.h>
+#include <ESOData/Serialization/SizedVector.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <string.h>
+
+using namespace esodata;
+using namespace esodata::checks;
+
+/*
+ * Writes index snapshots of a manifest and of a file table, then damages
+ * them: truncated, extended, and with single bits flipped anywhere. Every
+ * damaged snapshot must be rejected, so that the manifest is parsed and
+ * its snapshot written again, and the file table snapshot is not used.
+ *
+ * File table snapshots are also damaged behind a recomputed checksum, as
+ * if they had been written that way. Those with tables pointing out of
+ * bounds must still be rejected, and none may be read out of bounds.
+ */
+
+// The snapshot header ends with a CRC32 of everything after it.
+static const size_t SnapshotChecksumOffset = 16;
+static const size_t SnapshotBodyOffset = 20;
+
+static const size_t RandomFlipCount = 300;
+
+static const size_t FileTableRecordCount = 3000;
+
+static void forEachDamagedCopy(const std::vector<unsigned char> &snapshot, std::mt19937 &random, const std::function<void(const std::vector<unsigned char> &damaged)> &body) {
+	for (size_t size : { static_cast<size_t>(0), static_cast<size_t>(1), SnapshotBodyOffset - 1, SnapshotBodyOffset, snapshot.size() / 2, snapshot.size() - 1 }) {
+		body(std::vector<unsigned char>(snapshot.begin(), snapshot.begin() + size));
+	}
+
+	auto damaged = snapshot;
+	damaged.push_back(0);
+	body(damaged);
+
+	// Every bit of the header, and random bits of the body.
+	for (size_t flip = 0; flip < SnapshotBodyOffset * 8 + RandomFlipCount; flip++) {
+		size_t bit = flip;
+		if (flip >= SnapshotBodyOffset * 8)
+			bit = SnapshotBodyOffset * 8 + random() % ((snapshot.size() - SnapshotBodyOffset) * 8);
+
+		damaged = snapshot;
+		damaged[bit / 8] ^= static_cast<unsigned char>(1 << (bit % 8));
+		body(damaged);
+	}
+}
+
+static void resealSnapshot(std::vector<unsigned char> &snapshot) {
+	auto checksum = expectedFileCRC32(snapshot.data() + SnapshotBodyOffset, snapshot.size() - SnapshotBodyOffset);
+	memcpy(snapshot.data() + SnapshotChecksumOffset, &checksum, sizeof(checksum));
+}
+
+static void checkManifestSnapshots(std::mt19937 &random) {
+	TemporaryDirectory directory("ESOData-IndexSnapshotCheck");
+
+	auto files = makeRandomFiles(0x100, 200, 10, 8 * 1024);
+	writeSyntheticArchive(directory.path(), "game", files);
+
+	auto manifestFilename = directory.path() / "game.mnf";
+	auto snapshotFilename = manifestSnapshotFilename(manifestFilename);
+
+	auto mount = [&]() {
+		Filesystem fs;
+		fs.setIndexSnapshotsEnabled(true);
+		fs.addManifest(manifestFilename, false);
+
+		for (const auto &file : files) {
+			CHECK(fs.readFileByKey(file.key) == file.data);
+		}
+	};
+
+	mount();
+
+	auto snapshot = readWholeFile(snapshotFilename);
+
+	/*
+	 * The snapshot is dated back before every mount, so that a snapshot
+	 * written again can be told from one that was used.
+	 */
+	auto staleTime = std::filesystem::last_write_time(snapshotFilename) - std::chrono::hours(1);
+
+	std::filesystem::last_write_time(snapshotFilename, staleTime);
+	mount();
+	CHECK(std::filesystem::last_write_time(snapshotFilename) == staleTime);
+
+	size_t damagedCount = 0;
+
+	forEachDamagedCopy(snapshot, random, [&](const std::vector<unsigned char> &damaged) {
+		writeWholeFile(snapshotFilename, damaged);
+		std::filesystem::last_write_time(snapshotFilename, staleTime);
+
+		mount();
+
+		CHECK(std::filesystem::last_write_time(snapshotFilename) != staleTime);
+		CHECK(readWholeFile(snapshotFilename) == snapshot);
+
+		damagedCount++;
+	});
+
+	printf("%zu damaged manifest snapshots rejected and written again\n", damagedCount);
+}
+
+// A table as written by the game: buckets probed linearly from the hash of the key.
+template<typename Key, typename Value>
+static HashTableType3Data<Key, Value> makeTable(const std::vector<std::pair<Key, Value>> &pairs) {
+	HashTableType3Data<Key, Value> table;
+	table.hashTable.resize(pairs.empty() ? 0 : pairs.size() * 2 + 1);
+
+	for (const auto &pair : pairs) {
+		auto bucket = hashData64(reinterpret_cast<const unsigned char *>(&pair.first), sizeof(pair.first)) % table.hashTable.size();
+		while (table.hashTable[bucket] != 0)
+			bucket = (bucket + 1) % table.hashTable.size();
+
+		table.hashTable[bucket] = 0x80000000U | static_cast<uint32_t>(table.keys.size());
+		table.keys.push_back(pair.first);
+		table.values.push_back(pair.second);
+	}
+
+	return table;
+}
+
+// Names of the files in the table, as enumerateFileNames finds them.
+static std::vector<std::pair<uint32_t, std::string>> fileNames(const FileTable &table) {
+	std::vector<std::pair<uint32_t, std::string>> names;
+
+	for (const auto &entry : table.entries) {
+		CHECK(entry.second.nameOffset <= table.nameHeap.size());
+
+		auto nameBegin = table.nameHeap.begin() + entry.second.nameOffset;
+		names.emplace_back(entry.second.localFileKey, std::string(nameBegin, std::find(nameBegin, table.nameHeap.end(), '\0')));
+	}
+
+	std::sort(names.begin(), names.end());
+
+	return names;
+}
+
+static void checkFileTableSnapshots(std::mt19937 &random) {
+	std::vector<std::pair<uint64_t, uint32_t>> nameHashes;
+	std::vector<std::pair<uint32_t, FileTableEntry>> entries;
+	std::vector<std::pair<uint32_t, FileTableAdditionalData>> additionalData;
+	std::vector<char> nameHeap;
+
+	for (uint32_t index = 0; index < FileTableRecordCount; index++) {
+		auto nameHash = (static_cast<uint64_t>(random()) << 32) | random();
+		auto name = "file" + std::to_string(index) + ".dat";
+
+		nameHashes.emplace_back(nameHash, index);
+		entries.emplace_back(index, FileTableEntry{ 0x1000 + index, static_cast<uint32_t>(nameHeap.size()), nameHash });
+		nameHeap.insert(nameHeap.end(), name.begin(), name.end());
+		nameHeap.push_back('\0');
+
+		if (index % 30 == 0) {
+			FileTableAdditionalData data;
+			data.unknown1.fill(index);
+			additionalData.emplace_back(index, data);
+		}
+	}
+
+	auto nameHashTable = makeTable(nameHashes);
+	auto entryTable = makeTable(entries);
+	auto additionalDataTable = makeTable(additionalData);
+
+	static const std::array<unsigned char, 5> Signature{ 'Z', 'O', 'S', 'F', 'T' };
+
+	OutputSerializationStream output;
+	output.setSwapEndian(true);
+	output << Signature << static_cast<uint16_t>(1) << static_cast<uint32_t>(2) << static_cast<uint32_t>(3) << static_cast<uint32_t>(FileTableRecordCount);
+	output << static_cast<uint16_t>(3) << nameHashTable;
+	output << static_cast<uint16_t>(3) << entryTable;
+	output << static_cast<uint16_t>(3) << additionalDataTable;
+	output << makeSizedVector<uint32_t>(nameHeap) << Signature;
+
+	auto data = output.data();
+
+	InputSerializationStream stream(data.data(), data.data() + data.size());
+	stream.setSwapEndian(true);
+
+	FileTable table;
+	stream >> table;
+
+	auto expectedNames = fileNames(table);
+
+	ManifestFileEntry source = {};
+	source.uncompressedSize = static_cast<uint32_t>(data.size());
+	source.compressedSize = static_cast<uint32_t>(data.size() / 3);
+	source.fileCRC32 = expectedFileCRC32(data);
+
+	TemporaryDirectory directory("ESOData-IndexSnapshotCheck");
+	auto snapshotFilename = directory.path() / "table.esoidx";
+
+	writeFileTableSnapshot(snapshotFilename, source, table);
+	auto snapshot = readWholeFile(snapshotFilename);
+
+	{
+		FileTable loaded;
+		CHECK(readFileTableSnapshot(snapshotFilename, source, loaded));
+		CHECK(loaded.recordCount == FileTableRecordCount);
+		CHECK(fileNames(loaded) == expectedNames);
+	}
+
+	size_t damagedCount = 0;
+
+	forEachDamagedCopy(snapshot, random, [&](const std::vector<unsigned char> &damaged) {
+		writeWholeFile(snapshotFilename, damaged);
+
+		FileTable loaded;
+		CHECK(!readFileTableSnapshot(snapshotFilename, source, loaded));
+
+		damagedCount++;
+	});
+
+	/*
+	 * Offsets into the body, which holds the fixed fields of the table and
+	 * then each raw vector as its element count followed by the elements.
+	 */
+	size_t nameHashTableCountOffset = SnapshotBodyOffset + 3 * 4 + 2 + 3 * 4;
+	size_t nameHashTableOffset = nameHashTableCountOffset + 8;
+
+	size_t entryValuesOffset = nameHashTableOffset +
+		nameHashTable.hashTable.size() * 4 + 8 + nameHashTable.keys.size() * 8 + 8 + nameHashTable.values.size() * 4 +
+		8 + entryTable.hashTable.size() * 4 + 8 + entryTable.keys.size() * 4 + 8;
+
+	auto occupiedSlot = std::find_if(nameHashTable.hashTable.begin(), nameHashTable.hashTable.end(), [](uint32_t slot) { return slot != 0; }) - nameHashTable.hashTable.begin();
+
+	const std::function<void(std::vector<unsigned char> &damaged)> outOfBounds[] = {
+		// An element count whose size in bytes wraps around.
+		[&](std::vector<unsigned char> &damaged) {
+			uint64_t count = (~static_cast<uint64_t>(0) / 4) + 2;
+			memcpy(damaged.data() + nameHashTableCountOffset, &count, sizeof(count));
+		},
+
+		// A hash table slot pointing past the keys.
+		[&](std::vector<unsigned char> &damaged) {
+			uint32_t slot = 0x80000000U | static_cast<uint32_t>(nameHashTable.keys.size());
+			memcpy(damaged.data() + nameHashTableOffset + occupiedSlot * 4, &slot, sizeof(slot));
+		},
+
+		// A name past the end of the heap.
+		[&](std::vector<unsigned char> &damaged) {
+			uint32_t nameOffset = static_cast<uint32_t>(nameHeap.size() + 1);
+			memcpy(damaged.data() + entryValuesOffset + 16 * (FileTableRecordCount / 2) + 4, &nameOffset, sizeof(nameOffset));
+		}
+	};
+
+	for (const auto &damage : outOfBounds) {
+		auto damaged = snapshot;
+		damage(damaged);
+		resealSnapshot(damaged);
+		writeWholeFile(snapshotFilename, damaged);
+
+		FileTable loaded;
+		CHECK(!readFileTableSnapshot(snapshotFilename, source, loaded));
+	}
+
+	// Anything else that loads must be safe to walk.
+	size_t resealedLoadCount = 0;
+
+	for (size_t flip = 0; flip < RandomFlipCount; flip++) {
+		auto bit = SnapshotBodyOffset * 8 + random() % ((snapshot.size() - SnapshotBodyOffset) * 8);
+
+		auto damaged = snapshot;
+		damaged[bit / 8] ^= static_cast<unsigned char>(1 << (bit % 8));
+		resealSnapshot(damaged);
+		writeWholeFile(snapshotFilename, damaged);
+
+		FileTable loaded;
+		if (!readFileTableSnapshot(snapshotFilename, source, loaded))
+			continue;
+
+		fileNames(loaded);
+
+		for (const auto &pair : loaded.nameHashToLocalId) {
+			loaded.entries.find(pair.second);
+		}
+
+		for (const auto &pair : loaded.additionalData) {
+			loaded.entries.find(pair.first);
+		}
+
+		resealedLoadCount++;
+	}
+
+	printf("%zu damaged file table snapshots rejected, %zu of %zu resealed ones loaded safely\n", damagedCount + 3, resealedLoadCount, RandomFlipCount);
+}
+
+int main() {
+	std::mt19937 random(10);
+
+	checkManifestSnapshots(random);
+	checkFileTableSnapshots(random);
+
+	return 0;
+}
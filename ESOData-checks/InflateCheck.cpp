@@ -0,0 +1,180 @@
+#include "CheckSupport.h"
+
+#include <ESOData/Serialization/CRC32.h>
+#include <ESOData/Serialization/DeflatedSegment.h>
+#include <ESOData/Serialization/Inflate.h>
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <zlib.h>
+
+using namespace esodata;
+using namespace esodata::checks;
+
+/*
+ * Compares inflateWholeBuffer with zlib on streams produced by every
+ * compression level and strategy, so that stored, fixed and dynamic
+ * Huffman blocks are all covered, including empty and single byte inputs
+ * and sizes around the window size. The checksum computed during decoding
+ * must match fileCRC32 of the output. Damaged and truncated streams must
+ * either be rejected or decode exactly as zlib decodes them.
+ */
+
+static const size_t RandomStreamCount = 1500;
+static const size_t DamagedCopiesPerStream = 5;
+
+static std::vector<unsigned char> deflateWith(const std::vector<unsigned char> &data, int level, int strategy) {
+	z_stream stream = {};
+	CHECK(deflateInit2(&stream, level, Z_DEFLATED, 15, 8, strategy) == Z_OK);
+
+	std::vector<unsigned char> compressed(deflateBound(&stream, static_cast<uLong>(data.size())));
+	stream.next_in = data.data();
+	stream.avail_in = static_cast<uInt>(data.size());
+	stream.next_out = compressed.data();
+	stream.avail_out = static_cast<uInt>(compressed.size());
+
+	CHECK(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+	compressed.resize(stream.total_out);
+	deflateEnd(&stream);
+
+	return compressed;
+}
+
+// Decodes with zlib, requiring the same conditions as inflateWholeBuffer.
+static bool zlibInflateExactly(const std::vector<unsigned char> &compressed, std::vector<unsigned char> &output) {
+	z_stream stream = {};
+	CHECK(inflateInit(&stream) == Z_OK);
+
+	stream.next_in = compressed.data();
+	stream.avail_in = static_cast<uInt>(compressed.size());
+	stream.next_out = output.data();
+	stream.avail_out = static_cast<uInt>(output.size());
+
+	auto result = inflate(&stream, Z_FINISH);
+	bool decoded = result == Z_STREAM_END && stream.avail_in == 0 && stream.avail_out == 0;
+	inflateEnd(&stream);
+
+	return decoded;
+}
+
+static std::vector<unsigned char> makeInflateTestData(std::mt19937 &random, size_t size) {
+	std::vector<unsigned char> data(size);
+	auto kind = random() % 4;
+
+	for (size_t position = 0; position < size; position++) {
+		switch (kind) {
+		case 0:
+			data[position] = static_cast<unsigned char>(random());
+			break;
+
+		case 1:
+			data[position] = static_cast<unsigned char>((position / 13) ^ (random() % 3));
+			break;
+
+		case 2:
+			data[position] = static_cast<unsigned char>("abcabcabd"[position % 9]);
+			break;
+
+		default:
+			data[position] = random() % 7 == 0 || position == 0 ? static_cast<unsigned char>(random()) : data[position - 1];
+			break;
+		}
+	}
+
+	return data;
+}
+
+static void checkStream(std::mt19937 &random, const std::vector<unsigned char> &data, const std::vector<unsigned char> &compressed) {
+	auto size = data.size();
+
+	std::vector<unsigned char> output(size);
+	uint32_t checksum = 0;
+	CHECK(inflateWholeBuffer(compressed.data(), compressed.size(), output.data(), output.size(), &checksum));
+	CHECK(output == data);
+	CHECK(checksum == fileCRC32(data.data(), data.size()));
+
+	std::vector<unsigned char> plainOutput(size);
+	CHECK(inflateWholeBuffer(compressed.data(), compressed.size(), plainOutput.data(), plainOutput.size()));
+	CHECK(plainOutput == data);
+
+	// The output size must match exactly.
+	if (size != 0) {
+		std::vector<unsigned char> shorter(size - 1);
+		CHECK(!inflateWholeBuffer(compressed.data(), compressed.size(), shorter.data(), shorter.size()));
+	}
+
+	std::vector<unsigned char> longer(size + 1);
+	CHECK(!inflateWholeBuffer(compressed.data(), compressed.size(), longer.data(), longer.size()));
+
+	// The fallback to zlib produces the same data and checksum.
+	std::vector<unsigned char> viaLibrary(size);
+	CHECK(zlibUncompressAndChecksum(compressed.data(), compressed.size(), viaLibrary.data(), viaLibrary.size()) == checksum);
+	CHECK(viaLibrary == data);
+
+	if (size == 0)
+		return;
+
+	for (size_t copy = 0; copy < DamagedCopiesPerStream; copy++) {
+		auto damaged = compressed;
+		damaged[random() % damaged.size()] ^= static_cast<unsigned char>(1 << (random() % 8));
+		if (copy % 2 == 1)
+			damaged.resize(random() % damaged.size());
+
+		std::vector<unsigned char> decoded(size);
+		if (!inflateWholeBuffer(damaged.data(), damaged.size(), decoded.data(), decoded.size()))
+			continue;
+
+		std::vector<unsigned char> expected(size);
+		CHECK(zlibInflateExactly(damaged, expected));
+		CHECK(decoded == expected);
+	}
+}
+
+int main() {
+	std::mt19937 random(13);
+
+	static const int Strategies[] = { Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE, Z_FIXED };
+
+	// Edge cases at every level and strategy.
+	static const size_t EdgeSizes[] = { 0, 1, 2, 3, 257, 258, 259, 32767, 32768, 32769, 65535, 65536, 65537, 300000 };
+
+	size_t streams = 0;
+
+	for (auto size : EdgeSizes) {
+		auto data = makeInflateTestData(random, size);
+
+		for (int level = 0; level <= 9; level++) {
+			for (auto strategy : Strategies) {
+				checkStream(random, data, deflateWith(data, level, strategy));
+				streams++;
+			}
+		}
+	}
+
+	// Random sizes, contents, levels and strategies.
+	for (size_t index = 0; index < RandomStreamCount; index++) {
+		size_t size;
+		if (index % 50 == 0)
+			size = random() % (1024 * 1024);
+		else if (index % 3 == 0)
+			size = random() % 70000;
+		else
+			size = random() % 300;
+
+		auto data = makeInflateTestData(random, size);
+		checkStream(random, data, deflateWith(data, random() % 10, Strategies[random() % 5]));
+		streams++;
+	}
+
+	// Input that isn't a zlib stream at all.
+	std::vector<unsigned char> output(16);
+	static const unsigned char Garbage[] = { 0x12, 0x34, 0x56, 0x78 };
+	CHECK(!inflateWholeBuffer(Garbage, sizeof(Garbage), output.data(), output.size()));
+	CHECK(!inflateWholeBuffer(Garbage, 0, output.data(), output.size()));
+
+	printf("%zu streams decode as zlib decodes them\n", streams);
+
+	return 0;
+}
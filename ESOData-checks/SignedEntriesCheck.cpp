@@ -0,0 +1,254 @@
+#include "CheckSupport.h"
+#include "SyntheticArchive.h"
+
+#include <ESOData/Filesystem/FileSignature.h>
+#include <ESOData/Filesystem/Filesystem.h>
+#include <ESOData/Filesystem/MNFFile.h>
+#include <ESOData/Serialization/SerializationStream.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <openssl/bn.h>
+#include <openssl/dsa.h>
+#include <openssl/ec.h>
+#include <openssl/ecdsa.h>
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+#include <openssl/sha.h>
+#include <openssl/x509.h>
+
+using namespace esodata;
+using namespace esodata::checks;
+
+/*
+ * Reads a signed synthetic archive whose files are signed in turn with
+ * DSA, ECDSA (P-256) and RSA keys, with signatures in the format produced
+ * by CNG. Files with a corrupted signature must fail to read with a
+ * signature mismatch and be reported by verifyFiles; all others must read
+ * back as their payload. Range reads must skip the signature header, both
+ * with and without precise sizes.
+ */
+
+static const size_t FileCount = 60;
+static const size_t CorruptedFileInterval = 7;
+
+/*
+ * Private key of one of the supported types, producing signatures of the
+ * SHA-1 digest of the data in CNG format: raw r and s for DSA and ECDSA,
+ * PKCS #1 v1.5 for RSA.
+ */
+class TestSigner {
+public:
+	explicit TestSigner(int type) : m_type(type), m_key(nullptr) {
+		EVP_PKEY *parameters = nullptr;
+
+		if (type == EVP_PKEY_DSA) {
+			auto context = EVP_PKEY_CTX_new_id(EVP_PKEY_DSA, nullptr);
+			CHECK(context && EVP_PKEY_paramgen_init(context) > 0);
+			CHECK(EVP_PKEY_CTX_set_dsa_paramgen_bits(context, 1024) > 0);
+			CHECK(EVP_PKEY_CTX_set_dsa_paramgen_q_bits(context, 160) > 0);
+			CHECK(EVP_PKEY_paramgen(context, &parameters) > 0);
+			EVP_PKEY_CTX_free(context);
+		}
+
+		auto context = parameters ? EVP_PKEY_CTX_new(parameters, nullptr) : EVP_PKEY_CTX_new_id(type, nullptr);
+		CHECK(context && EVP_PKEY_keygen_init(context) > 0);
+
+		if (type == EVP_PKEY_EC)
+			CHECK(EVP_PKEY_CTX_set_ec_paramgen_curve_nid(context, NID_X9_62_prime256v1) > 0);
+		else if (type == EVP_PKEY_RSA)
+			CHECK(EVP_PKEY_CTX_set_rsa_keygen_bits(context, 2048) > 0);
+
+		CHECK(EVP_PKEY_keygen(context, &m_key) > 0);
+		EVP_PKEY_CTX_free(context);
+		EVP_PKEY_free(parameters);
+
+		unsigned char *encoded = nullptr;
+		int length = i2d_PUBKEY(m_key, &encoded);
+		CHECK(length > 0);
+		m_publicKey.assign(encoded, encoded + length);
+		OPENSSL_free(encoded);
+	}
+
+	~TestSigner() {
+		EVP_PKEY_free(m_key);
+	}
+
+	TestSigner(const TestSigner &other) = delete;
+	TestSigner &operator =(const TestSigner &other) = delete;
+
+	const std::vector<uint8_t> &publicKey() const {
+		return m_publicKey;
+	}
+
+	std::vector<uint8_t> sign(const std::vector<unsigned char> &data) const {
+		unsigned char digest[SHA_DIGEST_LENGTH];
+		SHA1(data.data(), data.size(), digest);
+
+		auto context = EVP_PKEY_CTX_new(m_key, nullptr);
+		CHECK(context && EVP_PKEY_sign_init(context) > 0);
+
+		if (m_type == EVP_PKEY_RSA) {
+			CHECK(EVP_PKEY_CTX_set_rsa_padding(context, RSA_PKCS1_PADDING) > 0);
+			CHECK(EVP_PKEY_CTX_set_signature_md(context, EVP_sha1()) > 0);
+		}
+
+		size_t length = 0;
+		CHECK(EVP_PKEY_sign(context, nullptr, &length, digest, sizeof(digest)) > 0);
+		std::vector<unsigned char> signature(length);
+		CHECK(EVP_PKEY_sign(context, signature.data(), &length, digest, sizeof(digest)) > 0);
+		signature.resize(length);
+		EVP_PKEY_CTX_free(context);
+
+		if (m_type == EVP_PKEY_RSA)
+			return signature;
+
+		const BIGNUM *r;
+		const BIGNUM *s;
+		const unsigned char *encoded = signature.data();
+		int half;
+
+		DSA_SIG *dsaSignature = nullptr;
+		ECDSA_SIG *ecdsaSignature = nullptr;
+
+		if (m_type == EVP_PKEY_DSA) {
+			dsaSignature = d2i_DSA_SIG(nullptr, &encoded, static_cast<long>(signature.size()));
+			CHECK(dsaSignature);
+			DSA_SIG_get0(dsaSignature, &r, &s);
+			half = 20;
+		}
+		else {
+			ecdsaSignature = d2i_ECDSA_SIG(nullptr, &encoded, static_cast<long>(signature.size()));
+			CHECK(ecdsaSignature);
+			ECDSA_SIG_get0(ecdsaSignature, &r, &s);
+			half = 32;
+		}
+
+		std::vector<uint8_t> raw(2 * half);
+		CHECK(BN_bn2binpad(r, raw.data(), half) == half);
+		CHECK(BN_bn2binpad(s, raw.data() + half, half) == half);
+
+		DSA_SIG_free(dsaSignature);
+		ECDSA_SIG_free(ecdsaSignature);
+
+		return raw;
+	}
+
+private:
+	int m_type;
+	EVP_PKEY *m_key;
+	std::vector<uint8_t> m_publicKey;
+};
+
+// Prefixes the payload with its FileSignature, as stored in signed manifests.
+static std::vector<unsigned char> signedEntry(const TestSigner &signer, const std::vector<unsigned char> &payload, bool corrupt) {
+	FileSignature signature;
+	signature.unknown = 0;
+	signature.publicKey = signer.publicKey();
+	signature.signature = signer.sign(payload);
+
+	if (corrupt)
+		signature.signature.back() ^= 1;
+
+	OutputSerializationStream stream;
+	stream.setSwapEndian(true);
+	stream << signature;
+
+	auto entry = stream.data();
+	entry.insert(entry.end(), payload.begin(), payload.end());
+
+	return entry;
+}
+
+int main() {
+	const TestSigner signers[] = {
+		TestSigner(EVP_PKEY_DSA),
+		TestSigner(EVP_PKEY_EC),
+		TestSigner(EVP_PKEY_RSA)
+	};
+
+	auto files = makeRandomFiles(0x100, FileCount, 8, 32 * 1024);
+	std::vector<std::vector<unsigned char>> payloads;
+	std::vector<uint64_t> keys;
+	std::vector<uint64_t> corruptedKeys;
+
+	for (size_t index = 0; index < files.size(); index++) {
+		auto &file = files[index];
+		bool corrupt = index % CorruptedFileInterval == CorruptedFileInterval - 1;
+
+		payloads.push_back(file.data);
+		keys.push_back(file.key);
+		if (corrupt)
+			corruptedKeys.push_back(file.key);
+
+		file.data = signedEntry(signers[index % 3], file.data, corrupt);
+	}
+
+	TemporaryDirectory directory("ESOData-SignedEntriesCheck");
+	writeSyntheticArchive(directory.path(), "game", files, 1, MNFFile::FileSignaturesPresentPossibility1);
+
+	Filesystem fs;
+	fs.addManifest(directory.path() / "game.mnf");
+
+	for (size_t index = 0; index < files.size(); index++) {
+		auto key = files[index].key;
+		bool corrupt = std::find(corruptedKeys.begin(), corruptedKeys.end(), key) != corruptedKeys.end();
+
+		CHECK(fs.fileSize(key) == payloads[index].size());
+
+		try {
+			auto data = fs.readFileByKey(key);
+			CHECK(!corrupt);
+			CHECK(data == payloads[index]);
+		}
+		catch (const std::runtime_error &error) {
+			CHECK(corrupt);
+			CHECK(std::string(error.what()).find("Signature mismatch") != std::string::npos);
+		}
+	}
+
+	auto failed = fs.verifyFiles(keys);
+	std::sort(failed.begin(), failed.end());
+	CHECK(failed == corruptedKeys);
+
+	printf("%zu signed files (DSA, ECDSA, RSA) read back, %zu corrupted signatures rejected\n", files.size(), failed.size());
+
+	/*
+	 * Ranges never start at the beginning of the payload, so that they are
+	 * not read in full and signatures are not verified.
+	 */
+	std::mt19937 random(6);
+	size_t rangeCount = 0;
+
+	for (bool preciseSizes : { true, false }) {
+		Filesystem rangeFs;
+		rangeFs.addManifest(directory.path() / "game.mnf", preciseSizes);
+
+		for (size_t index = 0; index < files.size(); index++) {
+			const auto &payload = payloads[index];
+			if (payload.empty())
+				continue;
+
+			for (int round = 0; round < 4; round++) {
+				size_t offset = 1 + random() % payload.size();
+				size_t size = random() % (payload.size() - offset + 2);
+
+				std::vector<unsigned char> range(size);
+				auto read = rangeFs.readRange(files[index].key, offset, range.data(), range.size());
+
+				CHECK(read == std::min(size, payload.size() - offset));
+				CHECK(std::equal(range.begin(), range.begin() + read, payload.begin() + offset));
+
+				rangeCount++;
+			}
+		}
+	}
+
+	printf("%zu ranges of signed files read past their signature headers\n", rangeCount);
+
+	return 0;
+}
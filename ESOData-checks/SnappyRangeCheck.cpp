@@ -0,0 +1,206 @@
+#include "CheckSupport.h"
+#include "SyntheticArchive.h"
+
+#include <ESOData/Filesystem/Codec.h>
+#include <ESOData/Filesystem/Filesystem.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <string.h>
+
+#include <snappy.h>
+
+using namespace esodata;
+using namespace esodata::checks;
+
+/*
+ * Compares range decoding of the Snappy codec with snappy::RawUncompress
+ * of the whole buffer, for prefixes (decoded by the codec itself) and for
+ * ranges anywhere in the data (decoded by the library), with the input
+ * split into chunks of random sizes. Then reads the same ranges through
+ * Filesystem::readRange and peekFile.
+ */
+
+static const size_t DataSetCount = 200;
+static const size_t RangesPerDataSet = 50;
+static const size_t MaximumDataSize = 256 * 1024;
+
+class ChunkedInput final : public CodecInput {
+public:
+	ChunkedInput(const std::string &data, std::mt19937 &random) : m_data(data), m_random(random), m_position(0) {
+
+	}
+
+	size_t next(const unsigned char *&data) override {
+		auto remaining = m_data.size() - m_position;
+		if (remaining == 0)
+			return 0;
+
+		// Mostly small chunks, so that tags and copies straddle chunk boundaries.
+		size_t chunk = m_random() % 4 == 0 ? remaining : 1 + m_random() % 300;
+		chunk = std::min(chunk, remaining);
+
+		data = reinterpret_cast<const unsigned char *>(m_data.data()) + m_position;
+		m_position += chunk;
+
+		return chunk;
+	}
+
+private:
+	const std::string &m_data;
+	std::mt19937 &m_random;
+	size_t m_position;
+};
+
+/*
+ * Random literals interleaved with runs repeating a short pattern, which
+ * Snappy encodes as copies overlapping their source, and with repeats of
+ * blocks from further back.
+ */
+static std::vector<unsigned char> makeSnappyTestData(std::mt19937 &random, size_t size) {
+	std::vector<unsigned char> data;
+	data.reserve(size);
+
+	while (data.size() < size) {
+		auto remaining = size - data.size();
+
+		switch (random() % 3) {
+		case 0:
+		{
+			auto length = std::min<size_t>(remaining, 1 + random() % 100);
+			for (size_t index = 0; index < length; index++) {
+				data.push_back(static_cast<unsigned char>(random()));
+			}
+
+			break;
+		}
+
+		case 1:
+		{
+			auto period = 1 + random() % 16;
+			auto length = std::min<size_t>(remaining, period + random() % 200);
+			for (size_t index = 0; index < length; index++) {
+				data.push_back(index < period ? static_cast<unsigned char>(random()) : data[data.size() - period]);
+			}
+
+			break;
+		}
+
+		default:
+		{
+			if (data.empty())
+				break;
+
+			auto begin = random() % data.size();
+			auto length = std::min<size_t>({ remaining, data.size() - begin, 1 + random() % 1000 });
+			for (size_t index = 0; index < length; index++) {
+				data.push_back(data[begin + index]);
+			}
+
+			break;
+		}
+		}
+	}
+
+	return data;
+}
+
+int main() {
+	std::mt19937 random(24);
+
+	const auto &codec = CodecRegistry::instance().require(CodecId::Snappy);
+
+	std::vector<unsigned char> output;
+	size_t checkedRanges = 0;
+
+	for (size_t dataSet = 0; dataSet < DataSetCount; dataSet++) {
+		auto data = makeSnappyTestData(random, random() % MaximumDataSize);
+
+		std::string compressed;
+		snappy::Compress(reinterpret_cast<const char *>(data.data()), data.size(), &compressed);
+
+		std::vector<unsigned char> expected(data.size());
+		CHECK(snappy::RawUncompress(compressed.data(), compressed.size(), reinterpret_cast<char *>(expected.data())));
+		CHECK(expected == data);
+
+		for (size_t rangeIndex = 0; rangeIndex < RangesPerDataSet; rangeIndex++) {
+			size_t offset = 0;
+			if (rangeIndex % 2 == 1 && !data.empty())
+				offset = random() % data.size();
+
+			size_t size = data.empty() ? 0 : random() % (data.size() - offset + 1);
+			if (rangeIndex == 0)
+				size = data.size();
+
+			output.assign(size + 1, 0xCD);
+
+			ChunkedInput input(compressed, random);
+			codec.decodeRange(input, offset, output.data(), size);
+
+			CHECK(memcmp(output.data(), expected.data() + offset, size) == 0);
+			CHECK(output[size] == 0xCD);
+
+			checkedRanges++;
+		}
+
+		// Ranges past the end of the data are rejected.
+		for (size_t offset : { size_t(0), data.size() / 2 + 1 }) {
+			if (offset > data.size())
+				continue;
+
+			output.resize(data.size() + 1);
+
+			ChunkedInput input(compressed, random);
+
+			bool threw = false;
+			try {
+				codec.decodeRange(input, offset, output.data(), data.size() - offset + 1);
+			}
+			catch (const std::runtime_error &) {
+				threw = true;
+			}
+
+			CHECK(threw);
+		}
+	}
+
+	printf("%zu Snappy ranges match snappy::RawUncompress\n", checkedRanges);
+
+	TemporaryDirectory directory("ESOData-SnappyRangeCheck");
+
+	auto files = makeRandomFiles(0x100, 60, 24, 192 * 1024);
+	for (auto &file : files) {
+		file.compressionType = FileCompressionType::Snappy;
+	}
+
+	writeSyntheticArchive(directory.path(), "game", files);
+
+	for (auto backend : { ArchiveIOBackend::Synchronous, ArchiveIOBackend::MemoryMapped }) {
+		Filesystem fs;
+		fs.setArchiveIOBackend(backend);
+		fs.addManifest(directory.path() / "game.mnf", false);
+
+		for (const auto &file : files) {
+			auto peekSize = random() % 256;
+			auto peeked = fs.peekFile(file.key, peekSize);
+			CHECK(peeked.size() == std::min(peekSize, file.data.size()));
+			CHECK(std::equal(peeked.begin(), peeked.end(), file.data.begin()));
+
+			for (size_t rangeIndex = 0; rangeIndex < 8; rangeIndex++) {
+				auto offset = file.data.empty() ? 0 : random() % file.data.size();
+				size_t size = random() % 4096;
+
+				output.assign(size, 0);
+				auto read = fs.readRange(file.key, offset, output.data(), size);
+
+				CHECK(read == std::min(size, file.data.size() - offset));
+				CHECK(memcmp(output.data(), file.data.data() + offset, read) == 0);
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,175 @@
+#ifndef ESODATA_CHECKS_SYNTHETIC_ARCHIVE_H
+#define ESODATA_CHECKS_SYNTHETIC_ARCHIVE_H
+
+#include <ESOData/Filesystem/DataFileHeader.h>
+#include <ESOData/Filesystem/ManifestFileEntry.h>
+#include <ESOData/Filesystem/MNFFile.h>
+#include <ESOData/Serialization/DeflatedSegment.h>
+#include <ESOData/Serialization/HashTable.h>
+#include <ESOData/Serialization/OutputSerializationStream.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+#include <snappy.h>
+
+namespace esodata {
+	namespace checks {
+		struct SyntheticFile {
+			uint64_t key;
+			std::vector<unsigned char> data;
+			FileCompressionType compressionType;
+		};
+
+		/*
+		 * Checksum of the contents as stored in manifests, computed with zlib
+		 * so that it doesn't depend on the library's own CRC implementation.
+		 */
+		inline uint32_t expectedFileCRC32(const unsigned char *data, size_t dataSize) {
+			uLong checksum = 0xFFFFFFFFU;
+
+			while (dataSize != 0) {
+				auto chunk = static_cast<uInt>(std::min<size_t>(dataSize, 1U << 30));
+				checksum = crc32(checksum, data, chunk);
+				data += chunk;
+				dataSize -= chunk;
+			}
+
+			return ~static_cast<uint32_t>(checksum);
+		}
+
+		inline uint32_t expectedFileCRC32(const std::vector<unsigned char> &data) {
+			return expectedFileCRC32(data.data(), data.size());
+		}
+
+		inline std::vector<unsigned char> compressForArchive(const std::vector<unsigned char> &data, FileCompressionType compressionType) {
+			switch (compressionType) {
+			case FileCompressionType::None:
+				return data;
+
+			case FileCompressionType::Deflate:
+				return zlibCompress(data.data(), data.size());
+
+			case FileCompressionType::Snappy:
+			{
+				std::vector<unsigned char> compressed(snappy::MaxCompressedLength(data.size()));
+				size_t compressedSize;
+				snappy::RawCompress(reinterpret_cast<const char *>(data.data()), data.size(), reinterpret_cast<char *>(compressed.data()), &compressedSize);
+				compressed.resize(compressedSize);
+
+				return compressed;
+			}
+
+			default:
+				throw std::logic_error("unsupported compression type");
+			}
+		}
+
+		/*
+		 * Files of random sizes, cycling through the compression types. The
+		 * contents are compressible, and every fifth file may be empty.
+		 */
+		inline std::vector<SyntheticFile> makeRandomFiles(uint64_t firstKey, size_t count, unsigned int seed, size_t maxSize) {
+			std::mt19937 random(seed);
+			std::vector<SyntheticFile> files(count);
+
+			for (size_t index = 0; index < count; index++) {
+				auto &file = files[index];
+				file.key = firstKey + index * 3;
+				file.compressionType = static_cast<FileCompressionType>(index % 3);
+
+				size_t size = random() % maxSize + (index % 5 == 0 ? 0 : 1);
+				file.data.resize(size);
+				for (size_t position = 0; position < size; position++) {
+					file.data[position] = static_cast<unsigned char>((position / 7) ^ (random() % 4) ^ index);
+				}
+			}
+
+			return files;
+		}
+
+		inline void writeWholeFile(const std::filesystem::path &filename, const std::vector<unsigned char> &data) {
+			std::ofstream stream;
+			stream.exceptions(std::ios::failbit | std::ios::badbit);
+			stream.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+			stream.write(reinterpret_cast<const char *>(data.data()), data.size());
+		}
+
+		/*
+		 * Writes name.mnf and its data files, name0000.dat onwards, into the
+		 * directory. Files are distributed over the data files in turn, and
+		 * fileFlags is stored in the manifest as is: the contents of files
+		 * in manifests with signatures must already carry them.
+		 */
+		inline void writeSyntheticArchive(const std::filesystem::path &directory, const std::string &name, const std::vector<SyntheticFile> &files,
+			size_t dataFileCount = 1, uint32_t fileFlags = 0) {
+
+			std::vector<OutputSerializationStream> dataFiles(dataFileCount);
+			for (auto &dataFile : dataFiles) {
+				DataFileHeader header;
+				header.version = DataFileHeader::ExpectedVersion;
+				header.unknown = 0;
+				header.headerSize = 14;
+				dataFile << header;
+			}
+
+			HashTableType3Data<uint64_t, ManifestFileEntry> table;
+			table.hashTable.resize(files.size() * 2 + 1);
+
+			for (size_t index = 0; index < files.size(); index++) {
+				const auto &file = files[index];
+				auto &dataFile = dataFiles[index % dataFileCount];
+
+				auto compressed = compressForArchive(file.data, file.compressionType);
+
+				ManifestFileEntry entry = {};
+				entry.uncompressedSize = static_cast<uint32_t>(file.data.size());
+				entry.compressedSize = static_cast<uint32_t>(compressed.size());
+				entry.fileCRC32 = expectedFileCRC32(file.data);
+				entry.fileOffset = static_cast<uint32_t>(dataFile.getCurrentPosition());
+				entry.compressionType = file.compressionType;
+				entry.archiveIndex = static_cast<uint8_t>(index % dataFileCount);
+
+				dataFile.writeData(compressed.data(), compressed.size());
+
+				// Some slack between files, so that extents don't simply abut.
+				static const unsigned char Padding[7] = { 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA };
+				dataFile.writeData(Padding, sizeof(Padding));
+
+				table.keys.push_back(file.key);
+				table.values.push_back(entry);
+
+				auto bucket = hashData64(reinterpret_cast<const unsigned char *>(&file.key), sizeof(file.key)) % table.hashTable.size();
+				while (table.hashTable[bucket] != 0)
+					bucket = (bucket + 1) % table.hashTable.size();
+
+				table.hashTable[bucket] = 0x80000000U | static_cast<uint32_t>(index);
+			}
+
+			OutputSerializationStream body;
+			body.setSwapEndian(true);
+			body << static_cast<uint16_t>(3) << table;
+			auto bodyData = body.data();
+
+			OutputSerializationStream manifest;
+			manifest << MNFFile::Signature << static_cast<uint16_t>(0x0102) << static_cast<uint32_t>(dataFileCount) << fileFlags;
+			manifest << static_cast<uint32_t>(bodyData.size());
+			manifest.writeData(bodyData.data(), bodyData.size());
+
+			writeWholeFile(directory / (name + ".mnf"), manifest.data());
+
+			for (size_t index = 0; index < dataFileCount; index++) {
+				char suffix[16];
+				snprintf(suffix, sizeof(suffix), "%04u.dat", static_cast<unsigned int>(index));
+				writeWholeFile(directory / (name + suffix), dataFiles[index].data());
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,207 @@
+#include <ESOData/Cryptography/SignatureVerifier.h>
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <ESOData/Cryptography/CNGAlgorithmProvider.h>
+#include <ESOData/Cryptography/CNGHash.h>
+#include <ESOData/Cryptography/CNGKey.h>
+
+#include <wchar.h>
+#else
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <openssl/dsa.h>
+#include <openssl/ecdsa.h>
+#include <openssl/bn.h>
+#include <openssl/rsa.h>
+#endif
+
+namespace esodata {
+#ifdef _WIN32
+	class SignatureVerifier::Key {
+	public:
+		explicit Key(const std::vector<uint8_t> &publicKey) : m_key(CNGKey::importDERPublicKey(publicKey)), m_rsa(false) {
+			wchar_t algorithm[32];
+			ULONG algorithmSize;
+			if (BCryptGetProperty(m_key, BCRYPT_ALGORITHM_NAME, reinterpret_cast<PUCHAR>(algorithm), sizeof(algorithm), &algorithmSize, 0) >= 0)
+				m_rsa = wcscmp(algorithm, BCRYPT_RSA_ALGORITHM) == 0;
+		}
+
+		bool verify(const unsigned char *digest, size_t digestSize, const std::vector<uint8_t> &signature) {
+			// RSA signatures are PKCS #1 v1.5 over the SHA-1 digest; DSA and ECDSA take no padding.
+			if (m_rsa) {
+				BCRYPT_PKCS1_PADDING_INFO padding = { BCRYPT_SHA1_ALGORITHM };
+				return m_key.verifySignature(&padding, digest, digestSize, signature.data(), signature.size(), BCRYPT_PAD_PKCS1);
+			}
+
+			return m_key.verifySignature(nullptr, digest, digestSize, signature.data(), signature.size(), 0);
+		}
+
+	private:
+		CNGKey m_key;
+		bool m_rsa;
+	};
+
+	static void hashSHA1(const unsigned char *data, size_t dataSize, std::vector<uint8_t> &digest) {
+		static thread_local CNGAlgorithmProvider sha1Provider(BCRYPT_SHA1_ALGORITHM, MS_PRIMITIVE_PROVIDER, BCRYPT_HASH_REUSABLE_FLAG);
+		static thread_local CNGHash hash(sha1Provider, nullptr, 0, BCRYPT_HASH_REUSABLE_FLAG);
+
+		hash.hashData(data, dataSize);
+		hash.finish(digest);
+	}
+#else
+	class SignatureVerifier::Key {
+	public:
+		explicit Key(const std::vector<uint8_t> &publicKey) {
+			auto data = publicKey.data();
+
+			m_key = d2i_PUBKEY(nullptr, &data, static_cast<long>(publicKey.size()));
+			if (!m_key)
+				throw std::runtime_error("failed to import the public key");
+		}
+
+		~Key() {
+			EVP_PKEY_free(m_key);
+		}
+
+		Key(const Key &other) = delete;
+		Key &operator =(const Key &other) = delete;
+
+		bool verify(const unsigned char *digest, size_t digestSize, const std::vector<uint8_t> &signature) {
+			auto encodedSignature = encodeSignature(signature);
+
+			struct ContextHolder {
+				EVP_PKEY_CTX *context;
+
+				~ContextHolder() {
+					EVP_PKEY_CTX_free(context);
+				}
+			} holder{ EVP_PKEY_CTX_new(m_key, nullptr) };
+
+			if (!holder.context || EVP_PKEY_verify_init(holder.context) <= 0)
+				throw std::runtime_error("EVP_PKEY_verify_init failed");
+
+			// As with CNG, RSA signatures are PKCS #1 v1.5 over the SHA-1 digest.
+			if (EVP_PKEY_base_id(m_key) == EVP_PKEY_RSA &&
+				(EVP_PKEY_CTX_set_rsa_padding(holder.context, RSA_PKCS1_PADDING) <= 0 ||
+				 EVP_PKEY_CTX_set_signature_md(holder.context, EVP_sha1()) <= 0))
+				throw std::runtime_error("failed to set up RSA verification");
+
+			int result = EVP_PKEY_verify(holder.context, encodedSignature.data(), encodedSignature.size(), digest, digestSize);
+			if (result < 0)
+				throw std::runtime_error("EVP_PKEY_verify failed");
+
+			return result == 1;
+		}
+
+	private:
+		/*
+		 * CNG DSA and ECDSA signatures are the raw concatenation of r and s,
+		 * while OpenSSL expects them DER-encoded. RSA signatures are the same
+		 * in both.
+		 */
+		std::vector<unsigned char> encodeSignature(const std::vector<uint8_t> &signature) const {
+			if (EVP_PKEY_base_id(m_key) == EVP_PKEY_RSA)
+				return std::vector<unsigned char>(signature.begin(), signature.end());
+
+			if (signature.empty() || signature.size() % 2 != 0)
+				throw std::runtime_error("malformed signature");
+
+			auto half = static_cast<int>(signature.size() / 2);
+			auto r = BN_bin2bn(signature.data(), half, nullptr);
+			auto s = BN_bin2bn(signature.data() + half, half, nullptr);
+
+			std::vector<unsigned char> encoded;
+			unsigned char *out = nullptr;
+			int length = -1;
+
+			switch (EVP_PKEY_base_id(m_key)) {
+			case EVP_PKEY_DSA:
+			{
+				auto dsaSignature = DSA_SIG_new();
+				DSA_SIG_set0(dsaSignature, r, s);
+				length = i2d_DSA_SIG(dsaSignature, &out);
+				DSA_SIG_free(dsaSignature);
+				break;
+			}
+
+			case EVP_PKEY_EC:
+			{
+				auto ecdsaSignature = ECDSA_SIG_new();
+				ECDSA_SIG_set0(ecdsaSignature, r, s);
+				length = i2d_ECDSA_SIG(ecdsaSignature, &out);
+				ECDSA_SIG_free(ecdsaSignature);
+				break;
+			}
+
+			default:
+				BN_free(r);
+				BN_free(s);
+				throw std::runtime_error("unsupported public key type");
+			}
+
+			if (length < 0)
+				throw std::runtime_error("failed to encode the signature");
+
+			encoded.assign(out, out + length);
+			OPENSSL_free(out);
+
+			return encoded;
+		}
+
+		EVP_PKEY *m_key;
+	};
+
+	static void hashSHA1(const unsigned char *data, size_t dataSize, std::vector<uint8_t> &digest) {
+		struct ContextHolder {
+			EVP_MD_CTX *context = EVP_MD_CTX_new();
+
+			~ContextHolder() {
+				EVP_MD_CTX_free(context);
+			}
+		};
+
+		static thread_local ContextHolder holder;
+
+		digest.resize(EVP_MAX_MD_SIZE);
+		unsigned int digestSize;
+
+		if (!holder.context ||
+			!EVP_DigestInit_ex(holder.context, EVP_sha1(), nullptr) ||
+			!EVP_DigestUpdate(holder.context, data, dataSize) ||
+			!EVP_DigestFinal_ex(holder.context, digest.data(), &digestSize))
+			throw std::runtime_error("SHA-1 hashing failed");
+
+		digest.resize(digestSize);
+	}
+#endif
+
+	SignatureVerifier::SignatureVerifier() = default;
+
+	SignatureVerifier::~SignatureVerifier() = default;
+
+	auto SignatureVerifier::importKey(const std::vector<uint8_t> &publicKey) -> std::shared_ptr<Key> {
+		std::unique_lock<std::mutex> locker(m_keysMutex);
+
+		auto it = m_keys.find(publicKey);
+		if (it != m_keys.end())
+			return it->second;
+
+		auto key = std::make_shared<Key>(publicKey);
+		m_keys.emplace(publicKey, key);
+
+		return key;
+	}
+
+	bool SignatureVerifier::verify(const std::vector<uint8_t> &publicKey, const unsigned char *data, size_t dataSize,
+		const std::vector<uint8_t> &signature) {
+
+		auto key = importKey(publicKey);
+
+		std::vector<uint8_t> digest;
+		hashSHA1(data, dataSize, digest);
+
+		return key->verify(digest.data(), digest.size(), signature);
+	}
+}
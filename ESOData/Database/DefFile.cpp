@@ -1,18 +1,36 @@
 #include <ESOData/Database/DefFile.h>
 
-#include <ESOData/Serialization/InputSerializationStream.h>
+#include <ESOData/Serialization/FastInputReader.h>
 #include <ESOData/Serialization/DeflatedSegment.h>
+#include <ESOData/Serialization/ScratchBuffer.h>
 
 #include <stdexcept>
+#include <algorithm>
 
 namespace esodata {
+	using DefFileReader = FastInputReader<true>;
+
+	template<typename Stream>
+	static void readHeader(Stream& stream, DefFileHeader& value) {
+		value.flags = 0;
+		value.itemCount = 0;
+
+		stream >> value.itemCount;
+
+		if (value.itemCount == DefFileHeader::FlagsPresentMagic) {
+			stream >> value.flags;
+			stream >> value.itemCount;
+		}
+
+		stream >> value.version;
+	}
+
 	void DefFileHeader::readFromData(const std::vector<unsigned char>& data, size_t &offset) {
-		InputSerializationStream stream(data.data() + offset, data.data() + data.size());
-		stream.setSwapEndian(true);
+		DefFileReader reader(data.data() + offset, data.data() + data.size());
 
-		stream >> *this;
+		readHeader(reader, *this);
 
-		offset += stream.getCurrentPosition();
+		offset += reader.position();
 	}
 
 
@@ -25,28 +43,58 @@ namespace esodata {
 	}
 
 	SerializationStream& operator >>(SerializationStream& stream, DefFileHeader& value) {
-		value.flags = 0;
-		value.itemCount = 0;
+		readHeader(stream, value);
 
-		stream >> value.itemCount;
+		return stream;
+	}
 
-		if (value.itemCount == DefFileHeader::FlagsPresentMagic) {
-			stream >> value.flags;
-			stream >> value.itemCount;
+	/*
+	 * Rows are the bulk of def files, so they are read without going through
+	 * DeflatedSegment: the record is decompressed straight into its storage
+	 * whenever its stated length matches the decompressed one, and through a
+	 * scratch buffer otherwise.
+	 */
+	template<typename Allocate>
+	static size_t readRow(const std::vector<unsigned char>& data, size_t& offset, Allocate&& allocate) {
+		DefFileReader reader(data.data() + offset, data.data() + data.size());
+
+		uint32_t expectedLength;
+		uint32_t uncompressedLength;
+		uint32_t compressedLength;
+
+		reader >> expectedLength >> uncompressedLength >> compressedLength;
+
+		auto compressedData = reader.readRegion(compressedLength);
+
+		if (expectedLength > uncompressedLength)
+			throw std::logic_error("read is out of bounds");
+
+		unsigned char* recordData = allocate(expectedLength);
+
+		if (expectedLength == uncompressedLength) {
+			zlibUncompress(compressedData, compressedLength, recordData, expectedLength);
+		}
+		else {
+			ScratchBuffer uncompressedBuffer;
+			auto uncompressedData = uncompressedBuffer.data(uncompressedLength);
+			zlibUncompress(compressedData, compressedLength, uncompressedData, uncompressedLength);
+			std::copy(uncompressedData, uncompressedData + expectedLength, recordData);
 		}
 
-		stream >> value.version;
+		offset += reader.position();
 
-		return stream;
+		return expectedLength;
 	}
 
 	void DefFileRow::readFromData(const std::vector<unsigned char>& data, size_t& offset) {
-		InputSerializationStream stream(data.data() + offset, data.data() + data.size());
-		stream.setSwapEndian(true);
-
-		stream >> *this;
+		readRow(data, offset, [this](size_t length) {
+			recordData.resize(length);
+			return recordData.data();
+		});
+	}
 
-		offset += stream.getCurrentPosition();
+	size_t DefFileRow::readFromDataInto(const std::vector<unsigned char>& data, size_t& offset, const std::function<unsigned char*(size_t length)>& allocate) {
+		return readRow(data, offset, allocate);
 	}
 
 
@@ -1,6 +1,10 @@
 #include <ESOData/Database/ESODatabase.h>
 #include <ESOData/Directives/DatabaseDirectiveFile.h>
 
+#include <ESOData/IO/ParallelFor.h>
+
+#include <algorithm>
+
 namespace esodata {
 	ESODatabase::ESODatabase(const Filesystem* fs) : m_fs(fs) {
 
@@ -9,7 +13,7 @@ namespace esodata {
 	ESODatabase::~ESODatabase() = default;
 
 
-	void ESODatabase::loadDirectives(std::filesystem::path& directoryPath) {
+	void ESODatabase::loadDirectives(const std::filesystem::path& directoryPath) {
 		m_parsingContext.emplace();
 
 		auto& parsingContext = *m_parsingContext;
@@ -73,4 +77,23 @@ namespace esodata {
 		return *it->second;
 	}
 
+	void ESODatabase::preload(const std::unordered_set<std::string>& names) const {
+		std::vector<const ESODatabaseDef*> defs;
+		defs.reserve(names.size());
+
+		for (const auto& name : names) {
+			defs.emplace_back(&findDefByName(name));
+		}
+
+		parallelFor(defs.size(), [&](size_t index) {
+			defs[index]->loadDef();
+		});
+	}
+
+	void ESODatabase::preloadAll() const {
+		parallelFor(m_defs.size(), [this](size_t index) {
+			m_defs[index].loadDef();
+		});
+	}
+
 }
@@ -4,19 +4,45 @@
 #include <ESOData/Database/DefFile.h>
 
 #include <ESOData/Filesystem/Filesystem.h>
-#include <ESOData/Serialization/InputSerializationStream.h>
+#include <ESOData/Serialization/FastInputReader.h>
 #include <ESOData/Serialization/DeflatedSegment.h>
 
 #include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 
 namespace esodata {
+	/*
+	 * Arrays of fixed-size scalars are read as one block, byteswapped at
+	 * once, and then widened into the record values.
+	 */
+	template<typename Wire, typename Stored>
+	static void parseScalarArray(FastInputReader<true>& stream, std::vector<ESODatabaseRecord::Value>& values) {
+		std::vector<Wire> wireValues(values.size());
+		stream >> wireValues;
+
+		for (size_t index = 0; index < values.size(); index++) {
+			values[index].emplace<Stored>(wireValues[index]);
+		}
+	}
+
+	struct ESODatabaseDef::LoadState {
+		std::mutex mutex;
+		std::atomic<bool> loaded = false;
+	};
 
 	ESODatabaseDef::ESODatabaseDef(const esodata::Filesystem* fs, const DatabaseDirectiveFile::Structure& def, const ESODatabaseParsingContext& parsingContext) :
 		m_id(def.defIndex),
 		m_name(def.name),
 		m_fs(fs),
 		m_def(&def),
-		m_parsingContext(&parsingContext) {
+		m_parsingContext(&parsingContext),
+		m_retainStrings(false),
+		m_loadState(std::make_unique<LoadState>()),
+		m_retainedBlockPosition(nullptr),
+		m_retainedBlockRemaining(0) {
 
 	}
 
@@ -26,9 +52,74 @@ namespace esodata {
 
 	ESODatabaseDef& ESODatabaseDef::operator =(ESODatabaseDef&& other) = default;
 
-	void ESODatabaseDef::loadDef() {
+	// Retained records are packed into blocks of this size, unless larger.
+	static const size_t RetainedRecordBlockSize = 256 * 1024;
+
+	ESODatabaseDef::LoadState& ESODatabaseDef::loadState() const {
+		if (!m_loadState)
+			throw std::logic_error("database def was moved from");
+
+		return *m_loadState;
+	}
+
+	bool ESODatabaseDef::retainStrings() const {
+		auto& state = loadState();
+
+		std::unique_lock<std::mutex> locker(state.mutex);
+
+		return m_retainStrings;
+	}
+
+	void ESODatabaseDef::setRetainStrings(bool retain) {
+		auto& state = loadState();
+
+		std::unique_lock<std::mutex> locker(state.mutex);
+
+		if (state.loaded.load(std::memory_order_relaxed)) {
+			std::stringstream error;
+			error << "cannot change string retention of database def " << m_name << " after it was loaded";
+			throw std::logic_error(error.str());
+		}
+
+		m_retainStrings = retain;
+	}
+
+	void ESODatabaseDef::loadDef() const {
+		auto& state = loadState();
+
+		if (state.loaded.load(std::memory_order_acquire))
+			return;
+
+		std::unique_lock<std::mutex> locker(state.mutex);
+
+		if (!state.loaded.load(std::memory_order_relaxed)) {
+			loadRecords();
+			state.loaded.store(true, std::memory_order_release);
+		}
+	}
+
+	const std::vector<ESODatabaseRecord>& ESODatabaseDef::records() const {
+		loadDef();
+
+		return m_records;
+	}
+
+	std::vector<ESODatabaseRecord>& ESODatabaseDef::records() {
+		loadDef();
+
+		return m_records;
+	}
+
+	void ESODatabaseDef::loadRecords() const {
 		auto defData = m_fs->readFileByKey(getDefFileId(m_id));
 
+		// Clears whatever a previous, failed attempt left behind.
+		m_records.clear();
+		m_recordLookup.clear();
+		m_retainedBlocks.clear();
+		m_retainedBlockPosition = nullptr;
+		m_retainedBlockRemaining = 0;
+
 		DefFileHeader header;
 		size_t offset = 0;
 		header.readFromData(defData, offset);
@@ -47,15 +138,32 @@ namespace esodata {
 
 		const auto& baseDef = m_parsingContext->findStructureByName("BaseDef");
 
+		// Reused across rows, so that its storage is only allocated once.
+		DefFileRow row;
+
 		for (auto& record : m_records) {
 			record.addField("flags").emplace<unsigned long long>(header.flags);
 			record.addField("version").emplace<unsigned long long>(header.version);
 
-			DefFileRow row;
-			row.readFromData(defData, offset);
+			const unsigned char* recordData;
+			size_t recordLength;
+
+			if (m_retainStrings) {
+				unsigned char* retained = nullptr;
+				recordLength = row.readFromDataInto(defData, offset, [this, &retained](size_t length) {
+					retained = retainRecordStorage(length);
+					return retained;
+				});
+
+				recordData = retained;
+			}
+			else {
+				row.readFromData(defData, offset);
+				recordData = row.recordData.data();
+				recordLength = row.recordData.size();
+			}
 
-			esodata::InputSerializationStream contentStream(row.recordData.data(), row.recordData.data() + row.recordData.size());
-			contentStream.setSwapEndian(true);
+			RecordReader contentStream(recordData, recordData + recordLength);
 
 			parseStructureIntoRecord(contentStream, baseDef, record);
 			parseStructureIntoRecord(contentStream, *m_def, record);
@@ -65,7 +173,7 @@ namespace esodata {
 		}
 	}
 
-	void ESODatabaseDef::parseField(esodata::SerializationStream& stream, DatabaseDirectiveFile::FieldType type, ESODatabaseRecord::Value& value, const DatabaseDirectiveFile::StructureField& field) {
+	void ESODatabaseDef::parseField(RecordReader& stream, DatabaseDirectiveFile::FieldType type, ESODatabaseRecord::Value& value, const DatabaseDirectiveFile::StructureField& field) const {
 		switch (type) {
 		case DatabaseDirectiveFile::FieldType::Int8:
 		{
@@ -150,9 +258,16 @@ namespace esodata {
 
 		case DatabaseDirectiveFile::FieldType::String:
 		{
-			std::string svalue;
-			stream >> svalue;
-			value.emplace<std::string>(std::move(svalue));
+			if (m_retainStrings) {
+				std::string_view svalue;
+				stream >> svalue;
+				value.emplace<std::string_view>(svalue);
+			}
+			else {
+				std::string svalue;
+				stream >> svalue;
+				value.emplace<std::string>(std::move(svalue));
+			}
 			break;
 		}
 
@@ -164,8 +279,40 @@ namespace esodata {
 
 			avalue.values.resize(length);
 
-			for (auto& value : avalue.values) {
-				parseField(stream, field.arrayType, value, field);
+			switch (field.arrayType) {
+			case DatabaseDirectiveFile::FieldType::Int16:
+				parseScalarArray<int16_t, long long>(stream, avalue.values);
+				break;
+
+			case DatabaseDirectiveFile::FieldType::Int32:
+				parseScalarArray<int32_t, long long>(stream, avalue.values);
+				break;
+
+			case DatabaseDirectiveFile::FieldType::Int64:
+				parseScalarArray<int64_t, long long>(stream, avalue.values);
+				break;
+
+			case DatabaseDirectiveFile::FieldType::UInt16:
+				parseScalarArray<uint16_t, unsigned long long>(stream, avalue.values);
+				break;
+
+			case DatabaseDirectiveFile::FieldType::UInt32:
+				parseScalarArray<uint32_t, unsigned long long>(stream, avalue.values);
+				break;
+
+			case DatabaseDirectiveFile::FieldType::UInt64:
+				parseScalarArray<uint64_t, unsigned long long>(stream, avalue.values);
+				break;
+
+			case DatabaseDirectiveFile::FieldType::Float:
+				parseScalarArray<float, double>(stream, avalue.values);
+				break;
+
+			default:
+				for (auto& value : avalue.values) {
+					parseField(stream, field.arrayType, value, field);
+				}
+				break;
 			}
 			break;
 		}
@@ -241,13 +388,31 @@ namespace esodata {
 		}
 	}
 
-	void ESODatabaseDef::parseStructureIntoRecord(esodata::SerializationStream& stream, const DatabaseDirectiveFile::Structure& structure, ESOFieldContainer& record) {
+	unsigned char* ESODatabaseDef::retainRecordStorage(size_t length) const {
+		if (length > m_retainedBlockRemaining) {
+			auto blockSize = std::max(length, RetainedRecordBlockSize);
+			m_retainedBlocks.emplace_back(new unsigned char[blockSize]);
+			m_retainedBlockPosition = m_retainedBlocks.back().get();
+			m_retainedBlockRemaining = blockSize;
+		}
+
+		auto retained = m_retainedBlockPosition;
+
+		m_retainedBlockPosition += length;
+		m_retainedBlockRemaining -= length;
+
+		return retained;
+	}
+
+	void ESODatabaseDef::parseStructureIntoRecord(RecordReader& stream, const DatabaseDirectiveFile::Structure& structure, ESOFieldContainer& record) const {
 		for (const auto& field : structure.fields) {
 			parseField(stream, field.type, record.addField(field.name), field);
 		}
 	}
 
 	const ESODatabaseRecord* ESODatabaseDef::findRecordById(uint64_t id) const {
+		loadDef();
+
 		auto it = m_recordLookup.find(id);
 		if (it == m_recordLookup.end()) {
 			return nullptr;
@@ -2,6 +2,7 @@
 #include <ESOData/Depot/IDepotLoadingCallback.h>
 
 #include <fstream>
+#include <algorithm>
 
 namespace esodata {
 	ESODepot::ESODepot() : m_database(&m_fs), m_dbManager(&m_fs) {
@@ -52,7 +53,7 @@ namespace esodata {
 	}
 	
 	unsigned int ESODepot::getExpectedNumberOfLoadingSteps() const {
-		return static_cast<unsigned int>(m_filesystem.manifests.size() + m_filesystem.fileTables.size() + m_database.defs().size());
+		return static_cast<unsigned int>(m_filesystem.manifests.size() + m_filesystem.fileTables.size());
 	}
 
 	bool ESODepot::load(IDepotLoadingCallback* callback) {
@@ -82,16 +83,11 @@ namespace esodata {
 					return false;
 			}
 		}
-		
-		for (auto& def : m_database.defs()) {
-			def.loadDef();
 
-			++progress;
-			if (callback) {
-				if (!callback->loadingStepsDone(1))
-					return false;
-			}
-		}
+		/*
+		 * Database defs are not loaded here: each one is loaded on first use,
+		 * or through ESODatabase::preload.
+		 */
 
 		return true;
 	}
@@ -132,7 +132,7 @@ namespace esodata {
 				m_buildingStructure = nullptr;
 			}
 			else {
-				auto tokenIt = tokens.begin();
+				auto tokenIt = tokens.cbegin();
 
 				auto& field = m_buildingStructure->fields.emplace_back();
 
@@ -1,196 +1,887 @@
 #include <ESOData/Filesystem/Archive.h>
+#include <ESOData/Filesystem/Codec.h>
 #include <ESOData/Filesystem/DataFileHeader.h>
 #include <ESOData/Filesystem/FileSignature.h>
+#include <ESOData/Filesystem/IndexSnapshot.h>
 
 #include <ESOData/IO/IOUtilities.h>
+#include <ESOData/IO/ParallelFor.h>
 
 #include <ESOData/Serialization/InputSerializationStream.h>
-#include <ESOData/Serialization/DeflatedSegment.h>
+#include <ESOData/Serialization/CRC32.h>
 
-#include <ESOData/Cryptography/CNGAlgorithmProvider.h>
-#include <ESOData/Cryptography/CNGKey.h>
-#include <ESOData/Cryptography/CNGHash.h>
-
-#include <archiveparse/EncodingUtilities.h>
-#include <archiveparse/WindowsError.h>
+#include <ESOData/Cryptography/SignatureVerifier.h>
 
 #include <sstream>
 #include <array>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
 
-#include <zlib.h>
-
-#include <snappy.h>
-#include "../Oodle/oodle.h"
+#include <string.h>
 
 namespace esodata {
-	Archive::Archive(const std::filesystem::path &manifestFilename, bool needPreciseSizes) {
+	/*
+	 * Batched reads merge extents separated by no more than CoalesceMaxGap
+	 * bytes, as long as the merged read does not exceed CoalesceMaxReadSize.
+	 */
+	static const uint64_t CoalesceMaxGap = 64 * 1024;
+	static const uint64_t CoalesceMaxReadSize = 8 * 1024 * 1024;
+
+	/*
+	 * Batched reads are issued in windows of at most ReadAheadMaxRuns reads,
+	 * and fetched data waiting to be decoded is limited to ReadAheadBudget
+	 * bytes.
+	 */
+	static const size_t ReadAheadMaxRuns = 256;
+	static const uint64_t ReadAheadBudget = 64 * 1024 * 1024;
+
+	// Granularity of reads feeding a streaming codec when decoding a byte range.
+	static const size_t RangeReadChunkSize = 64 * 1024;
+
+	/*
+	 * Slack given to codecs that can't decode straight into the destination,
+	 * as such decoders commonly write a few bytes past the end of the output.
+	 */
+	static const size_t CodecOutputPadding = 64;
+
+	// Granularity of copying stored entries, small enough for each chunk to be checksummed from cache.
+	static const size_t ChecksumChunkSize = 64 * 1024;
+
+	/*
+	 * Number of bytes decoded to parse the signature header of an entry. The
+	 * usual header is just under 500 bytes; entries with a longer one are
+	 * decoded in full.
+	 */
+	static const size_t SignatureHeaderProbeSize = 1024;
+
+	/*
+	 * Per-thread scratch storage reused across reads, so that staging the
+	 * compressed data and intermediate decoding results doesn't allocate for
+	 * every file. Buffers that had to grow beyond ScratchRetainLimit for a
+	 * large file are released once the read completes.
+	 */
+	static const size_t ScratchRetainLimit = 16 * 1024 * 1024;
+
+	static thread_local std::vector<unsigned char> StagingScratch;
+	static thread_local std::vector<unsigned char> IntermediateScratch;
+	static thread_local std::vector<unsigned char> PayloadScratch;
+	static thread_local std::vector<unsigned char> CodecOutputScratch;
+
+	static unsigned char *growScratch(std::vector<unsigned char> &scratch, size_t size) {
+		if (scratch.size() < size)
+			scratch.resize(size);
+
+		return scratch.data();
+	}
+
+	static void trimScratch() {
+		for (auto scratch : { &StagingScratch, &IntermediateScratch, &PayloadScratch, &CodecOutputScratch }) {
+			if (scratch->capacity() > ScratchRetainLimit)
+				std::vector<unsigned char>().swap(*scratch);
+		}
+	}
+
+	Archive::Archive(const std::filesystem::path &manifestFilename, bool needPreciseSizes, ArchiveIOBackend backend, bool useIndexSnapshot) :
+		m_manifestFilename(manifestFilename), m_preciseSizes(needPreciseSizes), m_manifest() {
+
+		IndexSnapshotStamp stamp;
+		bool loadedFromSnapshot = false;
+
 		{
 			auto data = readWholeFile(manifestFilename);
-			InputSerializationStream stream(data.data(), data.data() + data.size());
 
-			stream >> m_manifest;
+			if (useIndexSnapshot) {
+				stamp = IndexSnapshotStamp::ofManifest(manifestFilename, data);
+				loadedFromSnapshot = readManifestSnapshot(manifestSnapshotFilename(manifestFilename), stamp, needPreciseSizes, m_manifest, m_index);
+			}
+
+			if (!loadedFromSnapshot) {
+				m_manifest = MNFFile();
+				m_index = FlatIndex<ManifestFileEntry>();
+
+				InputSerializationStream stream(data.data(), data.data() + data.size());
+
+				stream >> m_manifest;
+			}
 		}
 
+		if (m_manifest.hasFileSignatures())
+			m_signatureVerifier = std::make_unique<SignatureVerifier>();
+
 		m_files.reserve(m_manifest.dataFileCount());
 
-		auto filenameString = archiveparse::wideToUtf8(manifestFilename.wstring());
+		auto baseName = manifestFilename.stem().u8string();
 
 		for (size_t index = 0, count = m_manifest.dataFileCount(); index < count; index++) {
 			std::stringstream name;
-			auto delim = filenameString.find_last_of('.');
-			name << filenameString.substr(0, delim);
+			name << baseName;
 			name.width(4);
 			name.fill('0');
 			name << index;
 			name << ".dat";
 
-			auto rawHandle = CreateFile(archiveparse::utf8ToWide(name.str()).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
-			if (rawHandle == INVALID_HANDLE_VALUE)
-				throw archiveparse::WindowsError();
-
-			archiveparse::WindowsHandle handle(rawHandle);
+			auto file = ArchiveDataFile::open(manifestFilename.parent_path() / std::filesystem::u8path(name.str()), backend);
 
 			std::array<unsigned char, 14> headerData;
-			DWORD bytesRead;
-			OVERLAPPED overlapped;
-			ZeroMemory(&overlapped, sizeof(overlapped));
-
-			if(!ReadFile(handle.get(), headerData.data(), static_cast<DWORD>(headerData.size()), &bytesRead, &overlapped))
-				throw archiveparse::WindowsError();
-
-			if (bytesRead != headerData.size())
-				throw std::runtime_error("short read");
+			file->read(0, headerData.data(), headerData.size());
 
 			InputSerializationStream stream(headerData.data(), headerData.data() + headerData.size());
 
 			DataFileHeader header;
 			stream >> header;
 
-			m_files.emplace_back(std::move(handle));
+			m_files.emplace_back(std::move(file));
 		}
 
-		if (m_manifest.hasFileSignatures()) {
-			for (auto it = m_manifest.body.data.files.begin(); it != m_manifest.body.data.files.end(); it++) {
-				auto &info = (*it).second;
+		if (m_manifest.hasFileSignatures() && !loadedFromSnapshot) {
+			auto &files = m_manifest.body.data.files;
 
-				if (needPreciseSizes) {
-					std::vector<unsigned char> data;
-					readFileByKey((*it).first, data);
-					info.cachedSize = data.size();
+			if (needPreciseSizes) {
+				std::vector<std::pair<uint64_t, ManifestFileEntry *>> entries;
+				for (auto it = files.begin(); it != files.end(); it++) {
+					auto pair = *it;
+					entries.emplace_back(pair.first, &pair.second);
 				}
-				else {
+
+				/*
+				 * Only the signature header needs to be decoded for most entries,
+				 * but the ones that have to be decoded in full can be numerous.
+				 */
+				parallelFor(entries.size(), [this, &entries](size_t index) {
+					auto &entry = *entries[index].second;
+
+					/*
+					 * Entries whose codec is missing can't be read anyway, so
+					 * they are left with the upper bound instead of failing the
+					 * whole archive.
+					 */
+					try {
+						entry.cachedSize = entry.uncompressedSize - static_cast<uint32_t>(signatureLength(entries[index].first, entry));
+					}
+					catch (const CodecUnavailableError &) {
+						entry.cachedSize = entry.uncompressedSize;
+					}
+
+					trimScratch();
+				});
+			}
+			else {
+				for (auto it = files.begin(); it != files.end(); it++) {
+					auto &info = (*it).second;
 					info.cachedSize = info.uncompressedSize;
 				}
 			}
 		}
+
+		if (!loadedFromSnapshot) {
+			/*
+			 * Lookups go through the flat index from now on; the hash table is
+			 * only needed to parse the manifest, so it is released. A snapshot
+			 * holds the index itself, so none of this is redone when loading
+			 * from one.
+			 */
+			auto &files = m_manifest.body.data.files;
+			for (auto it = files.begin(); it != files.end(); it++) {
+				const auto &pair = *it;
+				m_index.insert(pair.first, pair.second);
+			}
+
+			files = HashTable<uint64_t, ManifestFileEntry>();
+
+			if (useIndexSnapshot)
+				writeManifestSnapshot(manifestSnapshotFilename(manifestFilename), stamp, needPreciseSizes || !m_manifest.hasFileSignatures(), m_manifest, m_index);
+		}
 	}
 
 	Archive::~Archive() = default;
 
-	bool Archive::readFileByKey(uint64_t key, std::vector<unsigned char> &data) {
-		auto it = m_manifest.body.data.files.find(key);
-		if (it == m_manifest.body.data.files.end())
-			return false;
+	/*
+	 * Oodle compression is not recorded in the manifest; such entries are
+	 * recognized by their header, and the result may additionally be
+	 * compressed with the recorded compression type.
+	 */
+	static bool isOodleCompressed(const ManifestFileEntry &entry, const unsigned char *data) {
+		return entry.compressedSize >= 2 && (data[0] == 0x8c || data[0] == 0xcc) && (data[1] == 0x06 || data[1] == 0x0a);
+	}
 
-		const auto &entry = (*it).second;
+	static CodecId codecForCompressionType(FileCompressionType type) {
+		switch (type) {
+		case FileCompressionType::Deflate:
+			return CodecId::Deflate;
 
-		OVERLAPPED overlapped;
-		ZeroMemory(&overlapped, sizeof(overlapped));
-		overlapped.Offset = entry.fileOffset;
+		case FileCompressionType::Snappy:
+			return CodecId::Snappy;
 
-		data.resize(entry.compressedSize);
+		default:
+			throw std::logic_error("unsupported compression type");
+		}
+	}
+
+	/*
+	 * If checksum is not null, the output is also checksummed, while it is
+	 * being decoded for codecs that support that.
+	 */
+	static void decodeWithCodec(const Codec &codec, const unsigned char *input, size_t inputSize, unsigned char *output, size_t outputSize, uint32_t *checksum = nullptr) {
+		unsigned char *target = output;
+		if (!(codec.capabilities() & CodecDecodesIntoBuffer))
+			target = growScratch(CodecOutputScratch, outputSize + CodecOutputPadding);
+
+		if (checksum)
+			*checksum = codec.decodeAndChecksum(input, inputSize, target, outputSize);
+		else
+			codec.decode(input, inputSize, target, outputSize);
+
+		if (target != output)
+			memcpy(output, target, outputSize);
+	}
 
-		DWORD bytesRead;
-		if(!ReadFile(m_files[entry.archiveIndex].get(), data.data(), static_cast<DWORD>(data.size()), &bytesRead, &overlapped))
-			throw archiveparse::WindowsError();
+	/*
+	 * Copies stored data in chunks, checksumming each one while it is still
+	 * in cache.
+	 */
+	static uint32_t copyAndChecksum(const unsigned char *input, unsigned char *output, size_t size) {
+		uint32_t checksum = 0;
+
+		for (size_t offset = 0; offset < size; offset += ChecksumChunkSize) {
+			auto chunkSize = std::min(ChecksumChunkSize, size - offset);
+			memcpy(output + offset, input + offset, chunkSize);
+			checksum = fileCRC32Update(checksum, output + offset, chunkSize);
+		}
 
-		if (bytesRead != data.size())
-			throw std::runtime_error("short read");
+		return checksum;
+	}
 
-		bool oodle = false;
-		if ((data[0] == 0x8c || data[0] == 0xcc) && (data[1] == 0x06 || data[1] == 0x0a)) {
-			oodle = true;
-			//printf("OODLE %u\n", entry.compressionType);
-			std::vector<unsigned char> oodleOut(entry.uncompressedSize);
-			int bytesDecompressed = g_OodleDecompressFunc(data.data(), data.size(), reinterpret_cast<unsigned char*>(oodleOut.data()), entry.uncompressedSize, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3);
-			//printf("decompressed %u\n", bytesDecompressed);
-			if (bytesDecompressed != entry.uncompressedSize && entry.compressionType == FileCompressionType::None) {
-				//printf("NOT SAME AS DECOMPRESSED SIZE %u", entry.uncompressedSize);
+	/*
+	 * Feeds the stored bytes of an entry to decodeRange: straight from the
+	 * mapping if the data file is mapped, in RangeReadChunkSize reads if the
+	 * codec is streaming, and in a single read otherwise.
+	 */
+	class EntryCodecInput final : public CodecInput {
+	public:
+		EntryCodecInput(const ArchiveDataFile &file, const ManifestFileEntry &entry, bool streaming) :
+			m_file(file), m_entry(entry), m_streaming(streaming), m_position(0) {
+
+			m_mapped = file.mappedRegion(entry.fileOffset, entry.compressedSize);
+		}
+
+		size_t next(const unsigned char *&data) override {
+			auto remaining = static_cast<size_t>(m_entry.compressedSize - m_position);
+			if (remaining == 0)
+				return 0;
+
+			size_t chunk = remaining;
+
+			if (m_mapped) {
+				data = m_mapped + m_position;
 			}
-			data = std::move(oodleOut);
+			else {
+				if (m_streaming)
+					chunk = std::min(chunk, RangeReadChunkSize);
+
+				auto buffer = growScratch(StagingScratch, chunk);
+				m_file.read(m_entry.fileOffset + m_position, buffer, chunk);
+				data = buffer;
+			}
+
+			m_position += chunk;
+
+			return chunk;
 		}
 
-		switch (entry.compressionType) {
-		case FileCompressionType::None:
-			if (entry.compressedSize != entry.uncompressedSize && !oodle)
-				throw std::logic_error("compressed/uncompressed size mismatch");
+	private:
+		const ArchiveDataFile &m_file;
+		const ManifestFileEntry &m_entry;
+		bool m_streaming;
+		const unsigned char *m_mapped;
+		uint64_t m_position;
+	};
 
-			break;
+	const ManifestFileEntry *Archive::findEntry(uint64_t key) const {
+		return m_index.find(key);
+	}
 
-		case FileCompressionType::Deflate:
-		{
-			std::vector<unsigned char> uncompressedData(entry.uncompressedSize);
-			zlibUncompress(data.data(), data.size(), uncompressedData.data(), uncompressedData.size());
-			data = std::move(uncompressedData);
-			break;
+	void Archive::enumerateEntries(std::function<void(uint64_t key, const ManifestFileEntry &entry)> &&enumerator) const {
+		m_index.enumerate(enumerator);
+	}
+
+	size_t Archive::entrySize(const ManifestFileEntry &entry) const {
+		if (m_manifest.hasFileSignatures())
+			return entry.cachedSize;
+		else
+			return entry.uncompressedSize;
+	}
+
+	void Archive::prefetchEntries(const std::vector<const ManifestFileEntry *> &entries) const {
+		struct Extent {
+			size_t archiveIndex;
+			uint64_t start;
+			uint64_t end;
+		};
+
+		std::vector<Extent> extents;
+		extents.reserve(entries.size());
+
+		for (auto entry : entries) {
+			if (entry->archiveIndex < m_files.size() && entry->compressedSize != 0)
+				extents.push_back(Extent{ entry->archiveIndex, entry->fileOffset, static_cast<uint64_t>(entry->fileOffset) + entry->compressedSize });
 		}
 
-		case FileCompressionType::Snappy: {
-			std::vector<unsigned char> uncompressedData(entry.uncompressedSize);
+		std::sort(extents.begin(), extents.end(), [](const Extent &a, const Extent &b) {
+			if (a.archiveIndex != b.archiveIndex)
+				return a.archiveIndex < b.archiveIndex;
 
-			if (!snappy::RawUncompress(reinterpret_cast<const char *>(data.data()), data.size(), reinterpret_cast<char *>(uncompressedData.data())))
-				throw std::runtime_error("snappy::RawUncompress failed");
+			return a.start < b.start;
+		});
 
-			data = std::move(uncompressedData);
-			break;
+		for (size_t first = 0; first < extents.size();) {
+			auto archiveIndex = extents[first].archiveIndex;
+			auto start = extents[first].start;
+			auto end = extents[first].end;
 
+			size_t last = first + 1;
+			while (last < extents.size() && extents[last].archiveIndex == archiveIndex && extents[last].start <= end + CoalesceMaxGap) {
+				end = std::max(end, extents[last].end);
+				last++;
+			}
+
+			m_files[archiveIndex]->prefetch(start, static_cast<size_t>(end - start));
+
+			first = last;
 		}
+	}
 
-		default:
-			throw std::logic_error("unsupported compression type");
+	bool Archive::readFileByKey(uint64_t key, std::vector<unsigned char> &data) const {
+		auto entry = findEntry(key);
+		if (!entry)
+			return false;
+
+		readEntry(key, *entry, data);
+
+		return true;
+	}
+
+	bool Archive::readFileByKey(uint64_t key, FileView &data) const {
+		auto entry = findEntry(key);
+		if (!entry)
+			return false;
+
+		readEntry(key, *entry, data);
+
+		return true;
+	}
+
+	void Archive::readEntry(uint64_t key, const ManifestFileEntry &entry, std::vector<unsigned char> &data) const {
+		if (m_manifest.hasFileSignatures()) {
+			decodeEntry(key, entry, fetchCompressedData(entry, nullptr), data);
+		}
+		else {
+			/*
+			 * Stored entries are read straight into the destination.
+			 */
+			data.resize(entry.uncompressedSize);
+			decodeEntryInto(key, entry, fetchCompressedData(entry, data.data()), data.data());
 		}
 
-		auto checksum = ~crc32(0xffffffff, data.data(), static_cast<uInt>(data.size()));
+		trimScratch();
+	}
 
-		if (checksum != entry.fileCRC32) {
-			std::stringstream error;
-			error << "CRC32 mismatch for " << std::hex << key << ": expectected " << entry.fileCRC32 << ", got " << checksum;
-			throw std::runtime_error(error.str());
+	void Archive::readEntry(uint64_t key, const ManifestFileEntry &entry, FileView &data) const {
+		auto &file = m_files[entry.archiveIndex];
+
+		if (entry.compressionType == FileCompressionType::None && !m_manifest.hasFileSignatures()) {
+			auto mapped = file->mappedRegion(entry.fileOffset, entry.compressedSize);
+			if (mapped && !isOodleCompressed(entry, mapped)) {
+				if (entry.compressedSize != entry.uncompressedSize)
+					throw std::logic_error("compressed/uncompressed size mismatch");
+
+				verifyChecksum(key, entry, mapped, entry.compressedSize);
+
+				data = FileView(mapped, entry.compressedSize, file);
+
+				return;
+			}
+		}
+
+		std::vector<unsigned char> decoded;
+		readEntry(key, entry, decoded);
+
+		data = FileView(std::move(decoded));
+	}
+
+	size_t Archive::readEntryInto(uint64_t key, const ManifestFileEntry &entry, unsigned char *data, size_t dataSize) const {
+		size_t size;
+
+		if (m_manifest.hasFileSignatures()) {
+			auto payload = decodeSignedEntry(key, entry, fetchCompressedData(entry, nullptr), size);
+
+			if (dataSize < size)
+				throw std::logic_error("destination buffer is too small");
+
+			memcpy(data, payload, size);
 		}
+		else {
+			size = entry.uncompressedSize;
+
+			if (dataSize < size)
+				throw std::logic_error("destination buffer is too small");
+
+			decodeEntryInto(key, entry, fetchCompressedData(entry, data), data);
+		}
+
+		trimScratch();
+
+		return size;
+	}
+
+	size_t Archive::readEntryRange(uint64_t key, const ManifestFileEntry &entry, uint64_t offset, unsigned char *data, size_t dataSize) const {
+		uint64_t payloadOffset = 0;
+		uint64_t payloadSize = entry.uncompressedSize;
 
 		if (m_manifest.hasFileSignatures()) {
+			/*
+			 * Precise sizes leave out just the signature header. Entries whose
+			 * size couldn't be determined, and all entries without precise
+			 * sizes, have the header decoded to find its length.
+			 */
+			if (m_preciseSizes && entry.cachedSize < entry.uncompressedSize)
+				payloadOffset = entry.uncompressedSize - entry.cachedSize;
+			else
+				payloadOffset = signatureLength(key, entry);
+
+			payloadSize -= payloadOffset;
+		}
+
+		if (offset >= payloadSize)
+			return 0;
+
+		size_t length = static_cast<size_t>(std::min<uint64_t>(dataSize, payloadSize - offset));
+
+		if (offset == 0 && length == payloadSize)
+			return readEntryInto(key, entry, data, length);
+
+		readDecodedRange(key, entry, payloadOffset + offset, data, length);
+
+		trimScratch();
+
+		return length;
+	}
+
+	void Archive::readDecodedRange(uint64_t key, const ManifestFileEntry &entry, uint64_t offset, unsigned char *data, size_t dataSize) const {
+		auto &file = m_files[entry.archiveIndex];
+
+		std::array<unsigned char, 2> magic;
+		if (entry.compressedSize >= magic.size())
+			file->read(entry.fileOffset, magic.data(), magic.size());
+
+		if (!isOodleCompressed(entry, magic.data())) {
+			if (entry.compressionType == FileCompressionType::None) {
+				if (entry.compressedSize != entry.uncompressedSize)
+					throw std::logic_error("compressed/uncompressed size mismatch");
+
+				file->read(entry.fileOffset + offset, data, dataSize);
+
+				return;
+			}
+
+			auto codec = CodecRegistry::instance().find(codecForCompressionType(entry.compressionType));
+			if (codec && (codec->capabilities() & CodecSupportsRangeDecode) && codec->available()) {
+				EntryCodecInput input(*file, entry, (codec->capabilities() & CodecSupportsStreaming) != 0);
+				codec->decodeRange(input, offset, data, dataSize);
+
+				return;
+			}
+		}
 
-			InputSerializationStream stream(data.data(), data.data() + data.size());
+		auto decoded = growScratch(PayloadScratch, entry.uncompressedSize);
+		decodeEntryInto(key, entry, fetchCompressedData(entry, nullptr), decoded);
+		memcpy(data, decoded + offset, dataSize);
+	}
+
+	size_t Archive::signatureLength(uint64_t key, const ManifestFileEntry &entry) const {
+		size_t headerSize = std::min<size_t>(entry.uncompressedSize, SignatureHeaderProbeSize);
+
+		for (;;) {
+			std::vector<unsigned char> header(headerSize);
+			readDecodedRange(key, entry, 0, header.data(), header.size());
+
+			InputSerializationStream stream(header.data(), header.data() + header.size());
 			stream.setSwapEndian(true);
 
-			FileSignature signature;
-			stream >> signature;
+			/*
+			 * Walks the FileSignature layout without materializing the key and
+			 * the signature.
+			 */
+			try {
+				uint32_t unknown, publicKeyLength, signatureLength;
 
-			data.erase(data.begin(), data.begin() + stream.getCurrentPosition());
+				stream >> unknown >> publicKeyLength;
+				stream.getRegionForRead(publicKeyLength);
+				stream >> signatureLength;
+				stream.getRegionForRead(signatureLength);
 
-			CNGKey key = CNGKey::importDERPublicKey(signature.publicKey);
-			CNGAlgorithmProvider sha1Provider(BCRYPT_SHA1_ALGORITHM, MS_PRIMITIVE_PROVIDER, 0);
-			CNGHash hash(sha1Provider, nullptr, 0, 0);
-			hash.hashData(data.data(), data.size());
-			std::vector<uint8_t> digest;
-			hash.finish(digest);
+				return stream.getCurrentPosition();
+			}
+			catch (const std::logic_error &) {
+				if (headerSize == entry.uncompressedSize)
+					throw;
 
-			if (!key.verifySignature(nullptr, digest.data(), digest.size(), signature.signature.data(), signature.signature.size(), 0)) {
-				std::stringstream sstream;
-				sstream << "Signature mismatch for " << std::hex << key;
-				throw std::runtime_error(sstream.str());
+				headerSize = entry.uncompressedSize;
 			}
 		}
+	}
 
-		return true;
+	void Archive::readEntries(std::vector<std::pair<uint64_t, const ManifestFileEntry *>> &entries,
+		const std::function<void(uint64_t key, std::vector<unsigned char> &data)> &callback) const {
+
+		if (entries.empty())
+			return;
+
+		std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+			if (a.second->archiveIndex != b.second->archiveIndex)
+				return a.second->archiveIndex < b.second->archiveIndex;
+
+			return a.second->fileOffset < b.second->fileOffset;
+		});
+
+		struct Run {
+			size_t first;
+			size_t last;
+			uint64_t start;
+			uint64_t end;
+			const unsigned char *data;
+			std::vector<unsigned char> buffer;
+		};
+
+		std::vector<Run> runs;
+
+		for (size_t first = 0; first < entries.size();) {
+			const auto &firstEntry = *entries[first].second;
+
+			uint64_t runStart = firstEntry.fileOffset;
+			uint64_t runEnd = runStart + firstEntry.compressedSize;
+
+			size_t last = first + 1;
+			while (last < entries.size()) {
+				const auto &entry = *entries[last].second;
+				uint64_t entryEnd = static_cast<uint64_t>(entry.fileOffset) + entry.compressedSize;
+
+				if (entry.archiveIndex != firstEntry.archiveIndex ||
+					entry.fileOffset > runEnd + CoalesceMaxGap ||
+					std::max(runEnd, entryEnd) - runStart > CoalesceMaxReadSize)
+					break;
+
+				runEnd = std::max(runEnd, entryEnd);
+				last++;
+			}
+
+			runs.push_back(Run{ first, last, runStart, runEnd, nullptr, {} });
+
+			first = last;
+		}
+
+		/*
+		 * One invocation of the parallelFor below issues the reads and hands
+		 * completed runs to the others, which decode them. Fetched runs that
+		 * are not decoded yet are limited to ReadAheadBudget bytes; while over
+		 * it, the issuing invocation decodes too.
+		 */
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<size_t> ready;
+		uint64_t pendingBytes = 0;
+		bool submitted = false;
+		std::exception_ptr error;
+
+		std::mutex callbackMutex;
+
+		auto decodeNext = [&](std::unique_lock<std::mutex> &locker) {
+			auto index = ready.front();
+			ready.pop_front();
+
+			locker.unlock();
+
+			auto &run = runs[index];
+			std::exception_ptr failure;
+
+			try {
+				for (size_t entryIndex = run.first; entryIndex < run.last; entryIndex++) {
+					const auto &entry = *entries[entryIndex].second;
+
+					std::vector<unsigned char> data;
+					decodeEntry(entries[entryIndex].first, entry, run.data + (entry.fileOffset - run.start), data);
+
+					std::unique_lock<std::mutex> callbackLocker(callbackMutex);
+					callback(entries[entryIndex].first, data);
+				}
+			}
+			catch (...) {
+				failure = std::current_exception();
+			}
+
+			std::vector<unsigned char>().swap(run.buffer);
+
+			locker.lock();
+
+			pendingBytes -= run.end - run.start;
+			if (failure && !error)
+				error = failure;
+
+			condition.notify_all();
+		};
+
+		auto worker = [&]() {
+			std::unique_lock<std::mutex> locker(mutex);
+
+			for (;;) {
+				condition.wait(locker, [&]() { return !ready.empty() || submitted || error; });
+				if (error || ready.empty())
+					break;
+
+				decodeNext(locker);
+			}
+
+			locker.unlock();
+
+			trimScratch();
+		};
+
+		auto push = [&](size_t index) {
+			std::unique_lock<std::mutex> locker(mutex);
+
+			if (error)
+				std::rethrow_exception(error);
+
+			ready.push_back(index);
+			condition.notify_one();
+		};
+
+		auto produce = [&]() {
+			try {
+				for (size_t first = 0; first < runs.size();) {
+					auto archiveIndex = entries[runs[first].first].second->archiveIndex;
+
+					size_t last = first;
+					uint64_t windowBytes = 0;
+
+					while (last < runs.size() && last - first < ReadAheadMaxRuns &&
+						entries[runs[last].first].second->archiveIndex == archiveIndex &&
+						(last == first || windowBytes + (runs[last].end - runs[last].start) <= ReadAheadBudget)) {
+
+						windowBytes += runs[last].end - runs[last].start;
+						last++;
+					}
+
+					{
+						std::unique_lock<std::mutex> locker(mutex);
+
+						while (!error && pendingBytes != 0 && pendingBytes + windowBytes > ReadAheadBudget) {
+							if (ready.empty())
+								condition.wait(locker);
+							else
+								decodeNext(locker);
+						}
+
+						if (error)
+							break;
+
+						pendingBytes += windowBytes;
+					}
+
+					auto &file = m_files[archiveIndex];
+
+					std::vector<ArchiveReadRequest> requests;
+					std::vector<size_t> requestRuns;
+
+					for (size_t index = first; index < last; index++) {
+						auto &run = runs[index];
+						auto size = static_cast<size_t>(run.end - run.start);
+
+						run.data = file->mappedRegion(run.start, size);
+						if (run.data) {
+							push(index);
+						}
+						else {
+							run.buffer.resize(size);
+							run.data = run.buffer.data();
+
+							requests.push_back(ArchiveReadRequest{ run.start, run.buffer.data(), size });
+							requestRuns.push_back(index);
+						}
+					}
+
+					file->readBatch(requests, [&](size_t request) {
+						push(requestRuns[request]);
+					});
+
+					first = last;
+				}
+			}
+			catch (...) {
+				std::unique_lock<std::mutex> locker(mutex);
+				if (!error)
+					error = std::current_exception();
+			}
+
+			{
+				std::unique_lock<std::mutex> locker(mutex);
+				submitted = true;
+				condition.notify_all();
+			}
+		};
+
+		/*
+		 * The first invocation issues the reads, and then decodes like the
+		 * others. Invocations start in order, so the reads are being issued
+		 * by the time any decoder waits for them, even if every thread of the
+		 * pool is busy and the caller ends up running all of them.
+		 */
+		auto invocationCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1U), runs.size());
+
+		parallelFor(invocationCount, [&](size_t index) {
+			if (index == 0)
+				produce();
+
+			worker();
+		});
+
+		if (error)
+			std::rethrow_exception(error);
 	}
 
-	void Archive::enumerateFiles(std::function<void(uint64_t key, size_t size)> &&enumerator) {
-		for (auto it = m_manifest.body.data.files.begin(); it != m_manifest.body.data.files.end(); it++) {
-			if (m_manifest.hasFileSignatures())
-				enumerator((*it).first, (*it).second.cachedSize);
+	FileView Archive::readRawEntry(const ManifestFileEntry &entry, bool &mapped) const {
+		auto &file = m_files[entry.archiveIndex];
+
+		auto mappedData = file->mappedRegion(entry.fileOffset, entry.compressedSize);
+		if (mappedData) {
+			mapped = true;
+			return FileView(mappedData, entry.compressedSize, file);
+		}
+
+		mapped = false;
+
+		std::vector<unsigned char> data(entry.compressedSize);
+		file->read(entry.fileOffset, data.data(), data.size());
+
+		return FileView(std::move(data));
+	}
+
+	const unsigned char *Archive::fetchCompressedData(const ManifestFileEntry &entry, unsigned char *destination) const {
+		auto &file = m_files[entry.archiveIndex];
+
+		auto mapped = file->mappedRegion(entry.fileOffset, entry.compressedSize);
+		if (mapped)
+			return mapped;
+
+		/*
+		 * The destination can only receive the data directly if the stored
+		 * bytes are the final contents. Everything else is staged.
+		 */
+		if (!destination || entry.compressionType != FileCompressionType::None || entry.compressedSize != entry.uncompressedSize)
+			destination = growScratch(StagingScratch, entry.compressedSize);
+
+		file->read(entry.fileOffset, destination, entry.compressedSize);
+
+		return destination;
+	}
+
+	void Archive::decodeEntry(uint64_t key, const ManifestFileEntry &entry, const unsigned char *compressedData, std::vector<unsigned char> &data) const {
+		if (m_manifest.hasFileSignatures()) {
+			size_t size;
+			auto payload = decodeSignedEntry(key, entry, compressedData, size);
+			data.assign(payload, payload + size);
+		}
+		else {
+			data.resize(entry.uncompressedSize);
+			decodeEntryInto(key, entry, compressedData, data.data());
+		}
+	}
+
+	void Archive::decodeEntryInto(uint64_t key, const ManifestFileEntry &entry, const unsigned char *compressedData, unsigned char *data) const {
+		size_t compressedSize = entry.compressedSize;
+
+		bool oodle = false;
+		if (isOodleCompressed(entry, compressedData)) {
+			oodle = true;
+
+			auto &codec = CodecRegistry::instance().require(CodecId::Oodle);
+
+			if (compressedData == data) {
+				auto staged = growScratch(StagingScratch, compressedSize);
+				memcpy(staged, compressedData, compressedSize);
+				compressedData = staged;
+			}
+
+			unsigned char *oodleOut;
+			if (entry.compressionType == FileCompressionType::None)
+				oodleOut = data;
+			else
+				oodleOut = growScratch(IntermediateScratch, entry.uncompressedSize);
+
+			decodeWithCodec(codec, compressedData, compressedSize, oodleOut, entry.uncompressedSize);
+			compressedData = oodleOut;
+			compressedSize = entry.uncompressedSize;
+		}
+
+		uint32_t checksum;
+
+		if (entry.compressionType == FileCompressionType::None) {
+			if (entry.compressedSize != entry.uncompressedSize && !oodle)
+				throw std::logic_error("compressed/uncompressed size mismatch");
+
+			if (compressedData != data)
+				checksum = copyAndChecksum(compressedData, data, entry.uncompressedSize);
 			else
-				enumerator((*it).first, (*it).second.uncompressedSize);
+				checksum = fileCRC32(data, entry.uncompressedSize);
 		}
+		else {
+			auto &codec = CodecRegistry::instance().require(codecForCompressionType(entry.compressionType));
+			decodeWithCodec(codec, compressedData, compressedSize, data, entry.uncompressedSize, &checksum);
+		}
+
+		checkChecksum(key, entry, checksum);
+	}
+
+	const unsigned char *Archive::decodeSignedEntry(uint64_t key, const ManifestFileEntry &entry, const unsigned char *compressedData, size_t &size) const {
+		auto decoded = growScratch(PayloadScratch, entry.uncompressedSize);
+		decodeEntryInto(key, entry, compressedData, decoded);
+
+		InputSerializationStream stream(decoded, decoded + entry.uncompressedSize);
+		stream.setSwapEndian(true);
+
+		FileSignature signature;
+		stream >> signature;
+
+		auto payload = decoded + stream.getCurrentPosition();
+		size = entry.uncompressedSize - stream.getCurrentPosition();
+
+		if (!m_signatureVerifier->verify(signature.publicKey, payload, size, signature.signature)) {
+			std::stringstream sstream;
+			sstream << "Signature mismatch for " << std::hex << key;
+			throw std::runtime_error(sstream.str());
+		}
+
+		return payload;
+	}
+
+	void Archive::verifyChecksum(uint64_t key, const ManifestFileEntry &entry, const unsigned char *data, size_t dataSize) const {
+		checkChecksum(key, entry, fileCRC32(data, dataSize));
+	}
+
+	void Archive::checkChecksum(uint64_t key, const ManifestFileEntry &entry, uint32_t checksum) const {
+		if (checksum != entry.fileCRC32) {
+			std::stringstream error;
+			error << "CRC32 mismatch for " << std::hex << key << ": expectected " << entry.fileCRC32 << ", got " << checksum;
+			throw std::runtime_error(error.str());
+		}
+	}
+
+	void Archive::enumerateFiles(std::function<void(uint64_t key, size_t size)> &&enumerator) const {
+		m_index.enumerate([this, &enumerator](uint64_t key, const ManifestFileEntry &entry) {
+			enumerator(key, entrySize(entry));
+		});
 	}
 }
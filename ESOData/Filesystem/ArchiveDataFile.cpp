@@ -0,0 +1,52 @@
+#include <ESOData/Filesystem/ArchiveDataFile.h>
+#include <ESOData/Filesystem/SynchronousArchiveDataFile.h>
+#include <ESOData/Filesystem/MappedArchiveDataFile.h>
+#include <ESOData/Filesystem/IOUringArchiveDataFile.h>
+
+#include <stdexcept>
+
+namespace esodata {
+	ArchiveDataFile::ArchiveDataFile() = default;
+
+	ArchiveDataFile::~ArchiveDataFile() = default;
+
+	void ArchiveDataFile::readBatch(const std::vector<ArchiveReadRequest> &requests, const std::function<void(size_t index)> &completion) const {
+		for (size_t index = 0; index < requests.size(); index++) {
+			const auto &request = requests[index];
+
+			read(request.offset, request.data, request.size);
+			completion(index);
+		}
+	}
+
+	void ArchiveDataFile::prefetch(uint64_t offset, size_t size) const {
+		(void)offset;
+		(void)size;
+	}
+
+	std::shared_ptr<ArchiveDataFile> ArchiveDataFile::open(const std::filesystem::path &filename, ArchiveIOBackend backend) {
+		switch (backend) {
+		case ArchiveIOBackend::Default:
+#ifdef _WIN32
+			return std::make_shared<SynchronousArchiveDataFile>(filename);
+#else
+			return std::make_shared<MappedArchiveDataFile>(filename);
+#endif
+
+		case ArchiveIOBackend::Synchronous:
+			return std::make_shared<SynchronousArchiveDataFile>(filename);
+
+		case ArchiveIOBackend::MemoryMapped:
+			return std::make_shared<MappedArchiveDataFile>(filename);
+
+		case ArchiveIOBackend::IOUring:
+			if (IOUringArchiveDataFile::isSupported())
+				return std::make_shared<IOUringArchiveDataFile>(filename);
+			else
+				return std::make_shared<SynchronousArchiveDataFile>(filename);
+
+		default:
+			throw std::logic_error("unsupported archive I/O backend");
+		}
+	}
+}
@@ -0,0 +1,437 @@
+#include <ESOData/Filesystem/Codec.h>
+
+#include <ESOData/Serialization/DeflatedSegment.h>
+#include <ESOData/Serialization/CRC32.h>
+#include <ESOData/Serialization/ScratchBuffer.h>
+
+#include <sstream>
+#include <limits>
+#include <algorithm>
+
+#include <string.h>
+
+#include <zlib.h>
+
+#include <snappy.h>
+#include "../Oodle/oodle.h"
+
+namespace esodata {
+	// Granularity of output discarded while skipping to the start of a range.
+	static const size_t RangeDiscardChunkSize = 64 * 1024;
+
+	static thread_local std::vector<unsigned char> DiscardScratch;
+
+	class DeflateCodec final : public Codec {
+	public:
+		uint32_t capabilities() const override {
+			return CodecDecodesIntoBuffer | CodecSupportsStreaming | CodecSupportsRangeDecode;
+		}
+
+		void decode(const unsigned char *input, size_t inputSize, unsigned char *output, size_t outputSize) const override {
+			zlibUncompress(input, inputSize, output, outputSize);
+		}
+
+		uint32_t decodeAndChecksum(const unsigned char *input, size_t inputSize, unsigned char *output, size_t outputSize) const override {
+			return zlibUncompressAndChecksum(input, inputSize, output, outputSize);
+		}
+
+		void decodeRange(CodecInput &input, uint64_t offset, unsigned char *output, size_t outputSize) const override {
+			struct ManagedStream : z_stream {
+				ManagedStream() {
+					zalloc = Z_NULL;
+					zfree = Z_NULL;
+					opaque = Z_NULL;
+					next_in = Z_NULL;
+					avail_in = 0;
+
+					int result = inflateInit(this);
+					if (result != Z_OK)
+						throw std::runtime_error("zlib error");
+				}
+
+				~ManagedStream() {
+					inflateEnd(this);
+				}
+			} stream;
+
+			unsigned char *discard = nullptr;
+			uint64_t skip = offset;
+
+			while (skip != 0 || outputSize != 0) {
+				if (stream.avail_in == 0) {
+					const unsigned char *chunk;
+					auto chunkSize = input.next(chunk);
+					if (chunkSize == 0)
+						throw std::runtime_error("zlib error");
+
+					stream.next_in = chunk;
+					stream.avail_in = static_cast<uInt>(std::min<size_t>(chunkSize, std::numeric_limits<uInt>::max()));
+				}
+
+				if (skip != 0) {
+					if (!discard) {
+						if (DiscardScratch.size() < RangeDiscardChunkSize)
+							DiscardScratch.resize(RangeDiscardChunkSize);
+
+						discard = DiscardScratch.data();
+					}
+
+					stream.next_out = discard;
+					stream.avail_out = static_cast<uInt>(std::min<uint64_t>(RangeDiscardChunkSize, skip));
+				}
+				else {
+					stream.next_out = output;
+					stream.avail_out = static_cast<uInt>(std::min<size_t>(outputSize, std::numeric_limits<uInt>::max()));
+				}
+
+				auto availableOut = stream.avail_out;
+
+				int result = inflate(&stream, Z_NO_FLUSH);
+				if (result != Z_OK && result != Z_STREAM_END)
+					throw std::runtime_error("zlib error");
+
+				auto produced = availableOut - stream.avail_out;
+				if (skip != 0) {
+					skip -= produced;
+				}
+				else {
+					output += produced;
+					outputSize -= produced;
+				}
+
+				if (result == Z_STREAM_END && (skip != 0 || outputSize != 0))
+					throw std::runtime_error("zlib error");
+			}
+		}
+	};
+
+	/*
+	 * Pulls the compressed data of decodeRange from a CodecInput, crossing
+	 * chunk boundaries as needed.
+	 */
+	class CodecInputReader {
+	public:
+		explicit CodecInputReader(CodecInput &input) : m_input(input), m_data(nullptr), m_remaining(0) {
+
+		}
+
+		unsigned char readByte() {
+			if (m_remaining == 0)
+				fill();
+
+			m_remaining--;
+			return *m_data++;
+		}
+
+		void read(unsigned char *data, size_t dataSize) {
+			while (dataSize != 0) {
+				if (m_remaining == 0)
+					fill();
+
+				auto chunk = std::min(dataSize, m_remaining);
+				memcpy(data, m_data, chunk);
+				data += chunk;
+				dataSize -= chunk;
+				m_data += chunk;
+				m_remaining -= chunk;
+			}
+		}
+
+		uint32_t readLittleEndian(unsigned int bytes) {
+			uint32_t value = 0;
+			for (unsigned int index = 0; index < bytes; index++) {
+				value |= static_cast<uint32_t>(readByte()) << (8 * index);
+			}
+
+			return value;
+		}
+
+	private:
+		void fill() {
+			m_remaining = m_input.next(m_data);
+			if (m_remaining == 0)
+				throw std::runtime_error("unexpected end of Snappy data");
+		}
+
+		CodecInput &m_input;
+		const unsigned char *m_data;
+		size_t m_remaining;
+	};
+
+	class SnappyCodec final : public Codec {
+	public:
+		uint32_t capabilities() const override {
+			return CodecDecodesIntoBuffer | CodecSupportsStreaming | CodecSupportsRangeDecode;
+		}
+
+		void decode(const unsigned char *input, size_t inputSize, unsigned char *output, size_t outputSize) const override {
+			size_t uncompressedLength;
+			if (!snappy::GetUncompressedLength(reinterpret_cast<const char *>(input), inputSize, &uncompressedLength) ||
+				uncompressedLength != outputSize)
+				throw std::runtime_error("snappy::GetUncompressedLength failed");
+
+			if (!snappy::RawUncompress(reinterpret_cast<const char *>(input), inputSize, reinterpret_cast<char *>(output)))
+				throw std::runtime_error("snappy::RawUncompress failed");
+		}
+
+		/*
+		 * The Snappy library can only decode whole buffers. Ranges that start
+		 * at the beginning of the entry, as read by peekFile, are decoded
+		 * here instead, stopping as soon as the end of the range is reached.
+		 * Other ranges may copy from anywhere before them, so the whole entry
+		 * is decoded into scratch storage by the library.
+		 */
+		void decodeRange(CodecInput &input, uint64_t offset, unsigned char *output, size_t outputSize) const override {
+			if (offset > std::numeric_limits<size_t>::max() - outputSize)
+				throw std::runtime_error("Snappy range is too large");
+
+			size_t end = static_cast<size_t>(offset) + outputSize;
+
+			if (offset != 0) {
+				ScratchBuffer compressed;
+				auto &compressedData = compressed.storage();
+				compressedData.clear();
+
+				const unsigned char *chunk;
+				while (auto chunkSize = input.next(chunk)) {
+					compressedData.insert(compressedData.end(), chunk, chunk + chunkSize);
+				}
+
+				auto compressedInput = reinterpret_cast<const char *>(compressedData.data());
+
+				size_t uncompressedLength;
+				if (!snappy::GetUncompressedLength(compressedInput, compressedData.size(), &uncompressedLength))
+					throw std::runtime_error("snappy::GetUncompressedLength failed");
+
+				if (uncompressedLength < end)
+					throw std::runtime_error("Snappy range is out of bounds");
+
+				ScratchBuffer window;
+				auto decoded = window.data(uncompressedLength);
+				if (!snappy::RawUncompress(compressedInput, compressedData.size(), reinterpret_cast<char *>(decoded)))
+					throw std::runtime_error("snappy::RawUncompress failed");
+
+				memcpy(output, decoded + offset, outputSize);
+
+				return;
+			}
+
+			CodecInputReader reader(input);
+
+			uint64_t uncompressedLength = 0;
+			for (unsigned int shift = 0;; shift += 7) {
+				if (shift > 28)
+					throw std::runtime_error("malformed Snappy data");
+
+				auto byte = reader.readByte();
+				uncompressedLength |= static_cast<uint64_t>(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+					break;
+			}
+
+			if (uncompressedLength < end)
+				throw std::runtime_error("Snappy range is out of bounds");
+
+			size_t position = 0;
+			while (position < end) {
+				auto tag = reader.readByte();
+
+				size_t length;
+				if ((tag & 3) == 0) {
+					length = tag >> 2;
+					if (length >= 60)
+						length = reader.readLittleEndian(static_cast<unsigned int>(length - 59));
+
+					length++;
+
+					auto literal = std::min(length, end - position);
+					reader.read(output + position, literal);
+					position += literal;
+
+					continue;
+				}
+
+				size_t distance;
+				if ((tag & 3) == 1) {
+					length = 4 + ((tag >> 2) & 7);
+					distance = (static_cast<size_t>(tag >> 5) << 8) | reader.readByte();
+				}
+				else {
+					length = 1 + (tag >> 2);
+					distance = reader.readLittleEndian((tag & 3) == 2 ? 2 : 4);
+				}
+
+				if (distance == 0 || distance > position)
+					throw std::runtime_error("malformed Snappy data");
+
+				length = std::min(length, end - position);
+				copyMatch(output + position, distance, length);
+				position += length;
+			}
+		}
+
+	private:
+		/*
+		 * Copies length bytes from distance bytes back. A match longer than
+		 * its distance repeats the last distance bytes; the repeated pattern
+		 * is widened to at least 8 bytes so that it can be copied 8 bytes at
+		 * a time.
+		 */
+		static void copyMatch(unsigned char *target, size_t distance, size_t length) {
+			if (distance >= length) {
+				memcpy(target, target - distance, length);
+				return;
+			}
+
+			if (distance < 8) {
+				auto widened = distance * ((8 + distance - 1) / distance);
+				auto prefix = std::min(widened - distance, length);
+				auto source = target - distance;
+				for (size_t index = 0; index < prefix; index++) {
+					target[index] = source[index];
+				}
+
+				target += prefix;
+				length -= prefix;
+				distance = widened;
+			}
+
+			while (length >= 8) {
+				memcpy(target, target - distance, 8);
+				target += 8;
+				length -= 8;
+			}
+
+			if (length != 0)
+				memcpy(target, target - distance, length);
+		}
+	};
+
+	/*
+	 * Oodle is not redistributable, so the library is only looked up the
+	 * first time an Oodle-compressed entry is encountered, unless the
+	 * application has already loaded it with LoadOodleLib.
+	 *
+	 * OodleLZ decoders may write past the end of the output, so the codec
+	 * doesn't claim CodecDecodesIntoBuffer and decodes into padded scratch.
+	 */
+	class OodleCodec final : public Codec {
+	public:
+		uint32_t capabilities() const override {
+			return 0;
+		}
+
+		bool available() const override {
+			std::call_once(m_loadOnce, []() {
+				if (!g_OodleDecompressFunc)
+					LoadOodleLib();
+			});
+
+			return g_OodleDecompressFunc != nullptr;
+		}
+
+		void decode(const unsigned char *input, size_t inputSize, unsigned char *output, size_t outputSize) const override {
+			if (inputSize > static_cast<size_t>(std::numeric_limits<int>::max()) || outputSize > static_cast<size_t>(std::numeric_limits<int>::max()))
+				throw std::runtime_error("Oodle-compressed entry is too large");
+
+			auto decoded = g_OodleDecompressFunc(input, static_cast<int>(inputSize), output, static_cast<int>(outputSize), 0, 0, 0, 0, 0, 0, 0, 0, 0, 3);
+			if (decoded <= 0 && outputSize != 0)
+				throw std::runtime_error("OodleLZ_Decompress failed");
+
+			/*
+			 * Some entries decode to fewer bytes than their recorded size. As
+			 * before, that is left to the checksum of the entry to judge, with
+			 * the rest of the output zeroed.
+			 */
+			if (static_cast<size_t>(decoded) < outputSize)
+				memset(output + decoded, 0, outputSize - decoded);
+		}
+
+	private:
+		mutable std::once_flag m_loadOnce;
+	};
+
+	const char *codecName(CodecId id) {
+		switch (id) {
+		case CodecId::Deflate:
+			return "Deflate";
+
+		case CodecId::Snappy:
+			return "Snappy";
+
+		case CodecId::Oodle:
+			return "Oodle";
+
+		default:
+			return "unknown";
+		}
+	}
+
+	Codec::~Codec() = default;
+
+	bool Codec::available() const {
+		return true;
+	}
+
+	uint32_t Codec::decodeAndChecksum(const unsigned char *input, size_t inputSize, unsigned char *output, size_t outputSize) const {
+		decode(input, inputSize, output, outputSize);
+
+		return fileCRC32(output, outputSize);
+	}
+
+	void Codec::decodeRange(CodecInput &input, uint64_t offset, unsigned char *output, size_t outputSize) const {
+		(void)input;
+		(void)offset;
+		(void)output;
+		(void)outputSize;
+
+		throw std::logic_error("codec doesn't support range decoding");
+	}
+
+	CodecRegistry &CodecRegistry::instance() {
+		static CodecRegistry registry;
+		return registry;
+	}
+
+	CodecRegistry::CodecRegistry() {
+		for (auto &codec : m_codecs) {
+			codec.store(nullptr, std::memory_order_relaxed);
+		}
+
+		registerCodec(CodecId::Deflate, std::make_shared<DeflateCodec>());
+		registerCodec(CodecId::Snappy, std::make_shared<SnappyCodec>());
+		registerCodec(CodecId::Oodle, std::make_shared<OodleCodec>());
+	}
+
+	CodecRegistry::~CodecRegistry() = default;
+
+	void CodecRegistry::registerCodec(CodecId id, std::shared_ptr<const Codec> codec) {
+		if (id >= CodecId::Count)
+			throw std::logic_error("codec id is out of range");
+
+		std::unique_lock<std::mutex> locker(m_registrationMutex);
+
+		m_codecs[static_cast<size_t>(id)].store(codec.get(), std::memory_order_release);
+
+		if (codec)
+			m_registered.emplace_back(std::move(codec));
+	}
+
+	const Codec *CodecRegistry::find(CodecId id) const {
+		if (id >= CodecId::Count)
+			return nullptr;
+
+		return m_codecs[static_cast<size_t>(id)].load(std::memory_order_acquire);
+	}
+
+	const Codec &CodecRegistry::require(CodecId id) const {
+		auto codec = find(id);
+		if (!codec || !codec->available()) {
+			std::stringstream error;
+			error << codecName(id) << " codec is not available";
+			throw CodecUnavailableError(error.str());
+		}
+
+		return *codec;
+	}
+}
@@ -0,0 +1,89 @@
+#include <ESOData/Filesystem/FileCache.h>
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace esodata {
+	struct FileCache::Shard {
+		struct Item {
+			uint64_t key;
+			FileView data;
+		};
+
+		std::mutex mutex;
+		std::list<Item> items; // Most recently used first
+		std::unordered_map<uint64_t, std::list<Item>::iterator> index;
+		size_t bytes = 0;
+	};
+
+	FileCache::FileCache(size_t byteBudget) : m_byteBudget(byteBudget), m_shardBudget(byteBudget / ShardCount), m_shards(std::make_unique<Shard[]>(ShardCount)) {
+
+	}
+
+	FileCache::~FileCache() = default;
+
+	auto FileCache::shardForKey(uint64_t key) -> Shard & {
+		/*
+		 * File keys carry structure in both halves, so mix them before taking
+		 * the top bits.
+		 */
+		return m_shards[(key * 0x9E3779B97F4A7C15ULL) >> 60];
+	}
+
+	bool FileCache::find(uint64_t key, FileView &data) {
+		auto &shard = shardForKey(key);
+
+		std::unique_lock<std::mutex> locker(shard.mutex);
+
+		auto it = shard.index.find(key);
+		if (it == shard.index.end())
+			return false;
+
+		shard.items.splice(shard.items.begin(), shard.items, it->second);
+		data = it->second->data;
+
+		return true;
+	}
+
+	void FileCache::insert(uint64_t key, const FileView &data) {
+		if (data.size() > m_shardBudget)
+			return;
+
+		auto &shard = shardForKey(key);
+
+		std::unique_lock<std::mutex> locker(shard.mutex);
+
+		auto it = shard.index.find(key);
+		if (it != shard.index.end()) {
+			shard.bytes -= it->second->data.size();
+			it->second->data = data;
+			shard.items.splice(shard.items.begin(), shard.items, it->second);
+		}
+		else {
+			shard.items.push_front(Shard::Item{ key, data });
+			shard.index.emplace(key, shard.items.begin());
+		}
+
+		shard.bytes += data.size();
+
+		while (shard.bytes > m_shardBudget) {
+			auto &victim = shard.items.back();
+			shard.bytes -= victim.data.size();
+			shard.index.erase(victim.key);
+			shard.items.pop_back();
+		}
+	}
+
+	void FileCache::clear() {
+		for (size_t index = 0; index < ShardCount; index++) {
+			auto &shard = m_shards[index];
+
+			std::unique_lock<std::mutex> locker(shard.mutex);
+
+			shard.index.clear();
+			shard.items.clear();
+			shard.bytes = 0;
+		}
+	}
+}
@@ -48,17 +48,26 @@ namespace esodata {
 			>> table.unknown1
 			>> table.unknown2
 			>> table.unknown3
-			>> table.recordCount
-			>> table.nameHashToLocalId
-			>> table.entries
-			>> table.additionalData
-			>> makeSizedVector<uint32_t>(table.nameHeap);
+			>> table.recordCount;
+
+		/*
+		 * The segments of all three tables are located first, and then
+		 * decompressed together.
+		 */
+		DeflatedSegmentBatch batch;
+		readHashTable(stream, table.nameHashToLocalId, batch);
+		readHashTable(stream, table.entries, batch);
+		readHashTable(stream, table.additionalData, batch);
+
+		stream >> makeSizedVector<uint32_t>(table.nameHeap);
 
 		stream >> signature;
 
 		if (signature != FileTableExpectedSignature)
 			throw std::logic_error("bad ZOSFT signature");
 
+		batch.decode();
+
 		return stream;
 	}
 }
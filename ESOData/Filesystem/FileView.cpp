@@ -0,0 +1,44 @@
+#include <ESOData/Filesystem/FileView.h>
+
+namespace esodata {
+	FileView::FileView() noexcept : m_data(nullptr), m_size(0) {
+
+	}
+
+	FileView::FileView(std::vector<unsigned char> &&data) {
+		auto buffer = std::make_shared<const std::vector<unsigned char>>(std::move(data));
+		m_data = buffer->data();
+		m_size = buffer->size();
+		m_owner = std::move(buffer);
+	}
+
+	FileView::FileView(const unsigned char *data, size_t size, std::shared_ptr<const void> owner) noexcept :
+		m_owner(std::move(owner)), m_data(data), m_size(size) {
+
+	}
+
+	FileView::~FileView() = default;
+
+	FileView::FileView(const FileView &other) = default;
+
+	FileView &FileView::operator =(const FileView &other) = default;
+
+	FileView::FileView(FileView &&other) noexcept : m_owner(std::move(other.m_owner)), m_data(other.m_data), m_size(other.m_size) {
+		other.m_data = nullptr;
+		other.m_size = 0;
+	}
+
+	FileView &FileView::operator =(FileView &&other) noexcept {
+		m_owner = std::move(other.m_owner);
+		m_data = other.m_data;
+		m_size = other.m_size;
+		other.m_data = nullptr;
+		other.m_size = 0;
+
+		return *this;
+	}
+
+	std::vector<unsigned char> FileView::toVector() const {
+		return std::vector<unsigned char>(m_data, m_data + m_size);
+	}
+}
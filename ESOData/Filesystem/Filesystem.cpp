@@ -1,16 +1,55 @@
 #include <ESOData/Filesystem/Filesystem.h>
 #include <ESOData/Filesystem/Archive.h>
 #include <ESOData/Filesystem/FileTable.h>
+#include <ESOData/Filesystem/FileCache.h>
+#include <ESOData/Filesystem/IndexSnapshot.h>
+
+#include <ESOData/IO/ParallelFor.h>
 
 #include <sstream>
+#include <mutex>
+#include <algorithm>
+#include <unordered_map>
 
 namespace esodata {
-	Filesystem::Filesystem() = default;
+	Filesystem::Filesystem() : m_archiveIOBackend(ArchiveIOBackend::Default), m_indexSnapshotsEnabled(false) {
+
+	}
 
 	Filesystem::~Filesystem() = default;
 
+	void Filesystem::setCacheBudget(size_t decodedBytes, size_t compressedBytes) {
+		if (decodedBytes == 0)
+			m_decodedCache.reset();
+		else
+			m_decodedCache = std::make_unique<FileCache>(decodedBytes);
+
+		if (compressedBytes == 0)
+			m_compressedCache.reset();
+		else
+			m_compressedCache = std::make_unique<FileCache>(compressedBytes);
+	}
+
 	void Filesystem::addManifest(const std::filesystem::path &filename, bool needPreciseSizes) {
-		m_archives.emplace_back(std::make_unique<Archive>(filename, needPreciseSizes));
+		auto archive = std::make_unique<Archive>(filename, needPreciseSizes, m_archiveIOBackend, m_indexSnapshotsEnabled);
+		auto archivePtr = archive.get();
+
+		m_archives.emplace_back(std::move(archive));
+
+		archivePtr->enumerateEntries([this, archivePtr](uint64_t key, const ManifestFileEntry &entry) {
+			m_index.insert(key, FileLocation{ archivePtr, &entry });
+		});
+	}
+
+	auto Filesystem::findFile(uint64_t key) const -> const FileLocation * {
+		return m_index.find(key);
+	}
+
+	auto Filesystem::findFiles(const std::vector<uint64_t> &keys) const -> std::vector<const FileLocation *> {
+		std::vector<const FileLocation *> locations(keys.size());
+		m_index.findMany(keys.data(), keys.size(), locations.data());
+
+		return locations;
 	}
 	
 	std::vector<unsigned char> Filesystem::readFileByKey(uint64_t key) const {
@@ -26,21 +65,203 @@ namespace esodata {
 	}
 
 	bool Filesystem::tryReadFileByKey(uint64_t key, std::vector<unsigned char> &data) const {
+		auto location = findFile(key);
+		if (!location)
+			return false;
+
+		if (m_decodedCache || m_compressedCache) {
+			FileView view;
+			readCachedFile(key, *location, view);
+			data.assign(view.begin(), view.end());
+		}
+		else {
+			location->archive->readEntry(key, *location->entry, data);
+		}
+
+		return true;
+	}
+
+	void Filesystem::readFilesByKeys(const std::vector<uint64_t> &keys, std::function<void(uint64_t key, std::vector<unsigned char> &data)> &&callback) const {
+		std::unordered_map<const Archive *, std::vector<std::pair<uint64_t, const ManifestFileEntry *>>> batches;
+
+		auto locations = findFiles(keys);
+		for (size_t index = 0; index < keys.size(); index++) {
+			auto location = locations[index];
+			if (location)
+				batches[location->archive].emplace_back(keys[index], location->entry);
+		}
+
 		for (const auto &archive : m_archives) {
-			if (archive->readFileByKey(key, data)) {
-				return true;
+			auto it = batches.find(archive.get());
+			if (it != batches.end())
+				archive->readEntries(it->second, callback);
+		}
+	}
+
+	void Filesystem::prefetch(const std::vector<uint64_t> &keys) const {
+		std::unordered_map<const Archive *, std::vector<const ManifestFileEntry *>> batches;
+
+		for (auto location : findFiles(keys)) {
+			if (location)
+				batches[location->archive].emplace_back(location->entry);
+		}
+
+		for (const auto &batch : batches) {
+			batch.first->prefetchEntries(batch.second);
+		}
+	}
+
+	auto Filesystem::findExistingFile(uint64_t key) const -> const FileLocation & {
+		auto location = findFile(key);
+		if (!location) {
+			std::stringstream sstream;
+			sstream << "File not found: " << std::hex << key;
+			throw std::runtime_error(sstream.str());
+		}
+
+		return *location;
+	}
+
+	size_t Filesystem::fileSize(uint64_t key) const {
+		const auto &location = findExistingFile(key);
+
+		return location.archive->entrySize(*location.entry);
+	}
+
+	size_t Filesystem::readFileInto(uint64_t key, unsigned char *data, size_t dataSize) const {
+		const auto &location = findExistingFile(key);
+
+		return location.archive->readEntryInto(key, *location.entry, data, dataSize);
+	}
+
+	size_t Filesystem::readRange(uint64_t key, uint64_t offset, unsigned char *data, size_t dataSize) const {
+		const auto &location = findExistingFile(key);
+
+		return location.archive->readEntryRange(key, *location.entry, offset, data, dataSize);
+	}
+
+	std::vector<unsigned char> Filesystem::peekFile(uint64_t key, size_t size) const {
+		const auto &location = findExistingFile(key);
+
+		FileView cached;
+		if (m_decodedCache && m_decodedCache->find(key, cached))
+			return std::vector<unsigned char>(cached.begin(), cached.begin() + std::min(size, cached.size()));
+
+		std::vector<unsigned char> data(std::min(size, location.archive->entrySize(*location.entry)));
+		data.resize(location.archive->readEntryRange(key, *location.entry, 0, data.data(), data.size()));
+
+		return data;
+	}
+
+	std::vector<uint64_t> Filesystem::verifyFiles(const std::vector<uint64_t> &keys) const {
+		std::vector<uint64_t> failed;
+		std::mutex failedMutex;
+
+		auto locations = findFiles(keys);
+
+		parallelFor(keys.size(), [&](size_t index) {
+			auto key = keys[index];
+
+			auto location = locations[index];
+			if (!location)
+				return;
+
+			try {
+				std::vector<unsigned char> data;
+				location->archive->readEntry(key, *location->entry, data);
+			}
+			catch (const std::exception &) {
+				std::unique_lock<std::mutex> locker(failedMutex);
+				failed.emplace_back(key);
+			}
+		});
+
+		std::sort(failed.begin(), failed.end());
+
+		return failed;
+	}
+
+	FileView Filesystem::viewFileByKey(uint64_t key) const {
+		FileView data;
+
+		if (!tryViewFileByKey(key, data)) {
+			std::stringstream sstream;
+			sstream << "File not found: " << std::hex << key;
+			throw std::runtime_error(sstream.str());
+		}
+
+		return data;
+	}
+
+	bool Filesystem::tryViewFileByKey(uint64_t key, FileView &data) const {
+		auto location = findFile(key);
+		if (!location)
+			return false;
+
+		if (m_decodedCache || m_compressedCache)
+			readCachedFile(key, *location, data);
+		else
+			location->archive->readEntry(key, *location->entry, data);
+
+		return true;
+	}
+
+	void Filesystem::readCachedFile(uint64_t key, const FileLocation &location, FileView &data) const {
+		if (m_decodedCache && m_decodedCache->find(key, data))
+			return;
+
+		FileView raw;
+		if (!m_compressedCache || !m_compressedCache->find(key, raw)) {
+			bool mapped;
+			raw = location.archive->readRawEntry(*location.entry, mapped);
+
+			if (mapped) {
+				/*
+				 * Mapped data is already in memory, so only the decoded tier
+				 * is of use. Stored files are viewed in place and not cached.
+				 */
+				location.archive->readEntry(key, *location.entry, data);
+
+				if (m_decodedCache && data.data() != raw.data())
+					m_decodedCache->insert(key, data);
+
+				return;
 			}
+
+			if (m_compressedCache && location.entry->compressionType != FileCompressionType::None)
+				m_compressedCache->insert(key, raw);
 		}
 
-		return false;
+		std::vector<unsigned char> decoded;
+		location.archive->decodeEntry(key, *location.entry, raw.data(), decoded);
+		data = FileView(std::move(decoded));
+
+		if (m_decodedCache)
+			m_decodedCache->insert(key, data);
 	}
 
 	void Filesystem::loadFileTable(uint64_t fileTableKey) {
-		auto fileTableData = readFileByKey(fileTableKey);
+		const auto &location = findExistingFile(fileTableKey);
 
-		InputSerializationStream stream(fileTableData.data(), fileTableData.data() + fileTableData.size());
 		auto fileTable = std::make_unique<FileTable>();
-		stream >> *fileTable;
+
+		std::filesystem::path snapshotFilename;
+		bool loadedFromSnapshot = false;
+
+		if (m_indexSnapshotsEnabled) {
+			snapshotFilename = fileTableSnapshotFilename(location.archive->manifestFilename(), fileTableKey);
+			loadedFromSnapshot = readFileTableSnapshot(snapshotFilename, *location.entry, *fileTable);
+		}
+
+		if (!loadedFromSnapshot) {
+			auto fileTableData = readFileByKey(fileTableKey);
+
+			InputSerializationStream stream(fileTableData.data(), fileTableData.data() + fileTableData.size());
+			stream >> *fileTable;
+
+			if (m_indexSnapshotsEnabled)
+				writeFileTableSnapshot(snapshotFilename, *location.entry, *fileTable);
+		}
 
 		fileTable->globalIdPrefix = fileTableKey & 0xFFFFFFFE00000000ULL;
 
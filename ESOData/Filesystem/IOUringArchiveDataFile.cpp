@@ -0,0 +1,430 @@
+#include <ESOData/Filesystem/IOUringArchiveDataFile.h>
+
+#include <stdexcept>
+#include <system_error>
+
+#ifdef __linux__
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#include <linux/io_uring.h>
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+#endif
+
+namespace esodata {
+#ifdef __linux__
+	// Maximum number of reads a batch keeps in flight.
+	static const unsigned QueueDepth = 256;
+
+	// Reads are split into pieces of at most this size, as the length of a request is 32 bits wide.
+	static const size_t MaxReadSize = 1 << 30;
+
+	// Batches with more buffers than this are read without registering them.
+	static const size_t MaxRegisteredBuffers = 1024;
+
+	static void readAt(int fd, uint64_t offset, unsigned char *data, size_t size) {
+		while (size != 0) {
+			auto result = ::pread(fd, data, size, static_cast<off_t>(offset));
+			if (result < 0) {
+				if (errno == EINTR)
+					continue;
+
+				throw std::system_error(errno, std::generic_category(), "pread");
+			}
+
+			if (result == 0)
+				throw std::runtime_error("short read");
+
+			data += result;
+			size -= static_cast<size_t>(result);
+			offset += static_cast<uint64_t>(result);
+		}
+	}
+
+	/*
+	 * A minimal io_uring instance, driven through the system calls directly
+	 * so that liburing isn't needed. Submissions are only published to the
+	 * kernel by submitAndWait.
+	 */
+	class IOUring {
+	public:
+		explicit IOUring(unsigned entries) : m_sqRing(MAP_FAILED), m_cqRing(MAP_FAILED), m_sqes(MAP_FAILED), m_pendingTail(0), m_unsubmitted(0) {
+			io_uring_params params;
+			memset(&params, 0, sizeof(params));
+
+			m_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+			if (m_fd < 0)
+				throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+
+			m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+			bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+			if (singleMapping)
+				m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+
+			m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+			if (m_sqRing != MAP_FAILED) {
+				if (singleMapping)
+					m_cqRing = m_sqRing;
+				else
+					m_cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+			}
+
+			if (m_cqRing != MAP_FAILED)
+				m_sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+
+			if (m_sqes == MAP_FAILED) {
+				int error = errno;
+				release();
+				throw std::system_error(error, std::generic_category(), "mmap");
+			}
+
+			auto sqRing = static_cast<unsigned char *>(m_sqRing);
+			m_sqHead = reinterpret_cast<unsigned *>(sqRing + params.sq_off.head);
+			m_sqTail = reinterpret_cast<unsigned *>(sqRing + params.sq_off.tail);
+			m_sqMask = *reinterpret_cast<unsigned *>(sqRing + params.sq_off.ring_mask);
+			m_sqArray = reinterpret_cast<unsigned *>(sqRing + params.sq_off.array);
+			m_sqEntries = params.sq_entries;
+
+			auto cqRing = static_cast<unsigned char *>(m_cqRing);
+			m_cqHead = reinterpret_cast<unsigned *>(cqRing + params.cq_off.head);
+			m_cqTail = reinterpret_cast<unsigned *>(cqRing + params.cq_off.tail);
+			m_cqMask = *reinterpret_cast<unsigned *>(cqRing + params.cq_off.ring_mask);
+			m_cqes = reinterpret_cast<io_uring_cqe *>(cqRing + params.cq_off.cqes);
+
+			m_pendingTail = *m_sqTail;
+		}
+
+		~IOUring() {
+			release();
+		}
+
+		IOUring(const IOUring &other) = delete;
+		IOUring &operator =(const IOUring &other) = delete;
+
+		inline unsigned capacity() const {
+			return m_sqEntries;
+		}
+
+		bool registerResource(unsigned opcode, const void *arg, unsigned count) {
+			return syscall(__NR_io_uring_register, m_fd, opcode, arg, count) >= 0;
+		}
+
+		io_uring_sqe *nextSubmission() {
+			if (m_pendingTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) >= m_sqEntries)
+				throw std::logic_error("io_uring submission queue overflow");
+
+			unsigned index = m_pendingTail & m_sqMask;
+			m_sqArray[index] = index;
+			m_pendingTail++;
+			m_unsubmitted++;
+
+			auto sqe = static_cast<io_uring_sqe *>(m_sqes) + index;
+			memset(sqe, 0, sizeof(*sqe));
+
+			return sqe;
+		}
+
+		void submitAndWait(unsigned minComplete) {
+			__atomic_store_n(m_sqTail, m_pendingTail, __ATOMIC_RELEASE);
+
+			for (;;) {
+				auto result = syscall(__NR_io_uring_enter, m_fd, m_unsubmitted, minComplete, IORING_ENTER_GETEVENTS, nullptr, 0);
+				if (result < 0) {
+					if (errno == EINTR)
+						continue;
+
+					throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+				}
+
+				m_unsubmitted -= static_cast<unsigned>(result);
+
+				return;
+			}
+		}
+
+		/*
+		 * Passes every available completion to the handler. Each one is
+		 * consumed before the handler runs, so the handler may throw.
+		 */
+		template<typename Handler>
+		void reapCompletions(Handler &&handler) {
+			unsigned head = *m_cqHead;
+			unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+
+			while (head != tail) {
+				io_uring_cqe completion = m_cqes[head & m_cqMask];
+				head++;
+				__atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+
+				handler(completion);
+			}
+		}
+
+	private:
+		void release() {
+			if (m_sqes != MAP_FAILED)
+				munmap(m_sqes, m_sqesSize);
+
+			if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing)
+				munmap(m_cqRing, m_cqRingSize);
+
+			if (m_sqRing != MAP_FAILED)
+				munmap(m_sqRing, m_sqRingSize);
+
+			::close(m_fd);
+		}
+
+		int m_fd;
+		void *m_sqRing;
+		void *m_cqRing;
+		void *m_sqes;
+		size_t m_sqRingSize;
+		size_t m_cqRingSize;
+		size_t m_sqesSize;
+		unsigned *m_sqHead;
+		unsigned *m_sqTail;
+		unsigned m_sqMask;
+		unsigned *m_sqArray;
+		unsigned m_sqEntries;
+		unsigned *m_cqHead;
+		unsigned *m_cqTail;
+		unsigned m_cqMask;
+		io_uring_cqe *m_cqes;
+		unsigned m_pendingTail;
+		unsigned m_unsubmitted;
+	};
+
+	IOUringArchiveDataFile::IOUringArchiveDataFile(const std::filesystem::path &filename) {
+		m_fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+		if (m_fd < 0)
+			throw std::system_error(errno, std::generic_category(), "open");
+	}
+
+	IOUringArchiveDataFile::~IOUringArchiveDataFile() {
+		::close(m_fd);
+	}
+
+	void IOUringArchiveDataFile::read(uint64_t offset, unsigned char *data, size_t size) const {
+		readAt(m_fd, offset, data, size);
+	}
+
+	void IOUringArchiveDataFile::prefetch(uint64_t offset, size_t size) const {
+		posix_fadvise(m_fd, static_cast<off_t>(offset), static_cast<off_t>(size), POSIX_FADV_WILLNEED);
+	}
+
+	void IOUringArchiveDataFile::readBatch(const std::vector<ArchiveReadRequest> &requests, const std::function<void(size_t index)> &completion) const {
+		if (requests.size() <= 1) {
+			ArchiveDataFile::readBatch(requests, completion);
+			return;
+		}
+
+		std::unique_ptr<IOUring> ring;
+		try {
+			ring = std::make_unique<IOUring>(static_cast<unsigned>(std::min<size_t>(requests.size(), QueueDepth)));
+		}
+		catch (const std::system_error &) {
+			ArchiveDataFile::readBatch(requests, completion);
+			return;
+		}
+
+		/*
+		 * Registering the file and the buffers saves the kernel from looking
+		 * them up and pinning the pages for every read. Either may fail, e.g.
+		 * on the locked memory limit, in which case the reads go without.
+		 */
+		bool registeredFile = ring->registerResource(IORING_REGISTER_FILES, &m_fd, 1);
+
+		bool registeredBuffers = false;
+		if (requests.size() <= MaxRegisteredBuffers) {
+			std::vector<iovec> buffers;
+			buffers.reserve(requests.size());
+
+			bool registrable = true;
+			for (const auto &request : requests) {
+				if (request.size == 0 || request.size > MaxReadSize) {
+					registrable = false;
+					break;
+				}
+
+				buffers.push_back(iovec{ request.data, request.size });
+			}
+
+			if (registrable)
+				registeredBuffers = ring->registerResource(IORING_REGISTER_BUFFERS, buffers.data(), static_cast<unsigned>(buffers.size()));
+		}
+
+		std::vector<size_t> progress(requests.size(), 0);
+		size_t nextRequest = 0;
+		size_t inFlight = 0;
+		size_t completed = 0;
+
+		auto submit = [&](size_t index) {
+			const auto &request = requests[index];
+			auto done = progress[index];
+
+			auto sqe = ring->nextSubmission();
+			sqe->opcode = registeredBuffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+			sqe->flags = registeredFile ? IOSQE_FIXED_FILE : 0;
+			sqe->fd = registeredFile ? 0 : m_fd;
+			sqe->off = request.offset + done;
+			sqe->addr = reinterpret_cast<uint64_t>(request.data + done);
+			sqe->len = static_cast<uint32_t>(std::min(request.size - done, MaxReadSize));
+			sqe->buf_index = registeredBuffers ? static_cast<uint16_t>(index) : 0;
+			sqe->user_data = index;
+
+			inFlight++;
+		};
+
+		try {
+			while (completed != requests.size()) {
+				while (inFlight < ring->capacity() && nextRequest != requests.size()) {
+					auto index = nextRequest++;
+
+					if (requests[index].size == 0) {
+						completed++;
+						completion(index);
+					}
+					else {
+						submit(index);
+					}
+				}
+
+				if (inFlight == 0)
+					continue;
+
+				ring->submitAndWait(1);
+
+				ring->reapCompletions([&](const io_uring_cqe &cqe) {
+					inFlight--;
+
+					auto index = static_cast<size_t>(cqe.user_data);
+					const auto &request = requests[index];
+
+					if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+						submit(index);
+						return;
+					}
+					else if (cqe.res == -EINVAL || cqe.res == -EOPNOTSUPP) {
+						// Kernels without IORING_OP_READ.
+						readAt(m_fd, request.offset + progress[index], request.data + progress[index], request.size - progress[index]);
+						progress[index] = request.size;
+					}
+					else if (cqe.res < 0) {
+						throw std::system_error(-cqe.res, std::generic_category(), "io_uring read");
+					}
+					else if (cqe.res == 0) {
+						throw std::runtime_error("short read");
+					}
+					else {
+						progress[index] += static_cast<size_t>(cqe.res);
+
+						if (progress[index] != request.size) {
+							submit(index);
+							return;
+						}
+					}
+
+					completed++;
+					completion(index);
+				});
+			}
+		}
+		catch (...) {
+			/*
+			 * The reads still in flight target the caller's buffers, so they
+			 * have to land before the exception may propagate.
+			 */
+			try {
+				while (inFlight != 0) {
+					ring->submitAndWait(1);
+					ring->reapCompletions([&](const io_uring_cqe &) {
+						inFlight--;
+					});
+				}
+			}
+			catch (const std::system_error &) {
+
+			}
+
+			throw;
+		}
+	}
+
+	bool IOUringArchiveDataFile::isSupported() {
+		static std::once_flag probeOnce;
+		static bool supported = false;
+
+		std::call_once(probeOnce, []() {
+			try {
+				IOUring probe(1);
+				supported = true;
+			}
+			catch (const std::system_error &) {
+				supported = false;
+			}
+		});
+
+		return supported;
+	}
+#else
+	IOUringArchiveDataFile::IOUringArchiveDataFile(const std::filesystem::path &filename) : m_fd(-1) {
+		(void)filename;
+
+		throw std::logic_error("io_uring archive I/O is not supported on this platform");
+	}
+
+	IOUringArchiveDataFile::~IOUringArchiveDataFile() = default;
+
+	void IOUringArchiveDataFile::read(uint64_t offset, unsigned char *data, size_t size) const {
+		(void)offset;
+		(void)data;
+		(void)size;
+
+		throw std::logic_error("io_uring archive I/O is not supported on this platform");
+	}
+
+	void IOUringArchiveDataFile::prefetch(uint64_t offset, size_t size) const {
+		(void)offset;
+		(void)size;
+	}
+
+	void IOUringArchiveDataFile::readBatch(const std::vector<ArchiveReadRequest> &requests, const std::function<void(size_t index)> &completion) const {
+		ArchiveDataFile::readBatch(requests, completion);
+	}
+
+	bool IOUringArchiveDataFile::isSupported() {
+		return false;
+	}
+#endif
+
+	const unsigned char *IOUringArchiveDataFile::mappedRegion(uint64_t offset, size_t size) const {
+		(void)offset;
+		(void)size;
+
+		return nullptr;
+	}
+}
@@ -0,0 +1,237 @@
+#include <ESOData/Filesystem/IndexSnapshot.h>
+#include <ESOData/Filesystem/ArchiveDataFile.h>
+#include <ESOData/Filesystem/MNFFile.h>
+#include <ESOData/Filesystem/FileTable.h>
+#include <ESOData/Filesystem/FlatIndex.h>
+
+#include <ESOData/IO/IOUtilities.h>
+
+#include <ESOData/Serialization/InputSerializationStream.h>
+#include <ESOData/Serialization/OutputSerializationStream.h>
+#include <ESOData/Serialization/CRC32.h>
+
+#include <functional>
+#include <memory>
+#include <sstream>
+
+namespace esodata {
+	enum : uint32_t {
+		IndexSnapshotSignature = 0x58495345, // Little-endian 'ESIX'
+		IndexSnapshotVersion = 3,
+	};
+
+	enum class IndexSnapshotKind : uint32_t {
+		Manifest = 1,
+		FileTable = 2
+	};
+
+	/*
+	 * Snapshots contain in-memory representations of the structures below,
+	 * so any change to their layout must invalidate existing snapshots.
+	 * Manifest snapshots also hold the slots of the flat index as placed by
+	 * its key mixer; changing how FlatIndex places keys requires a new
+	 * IndexSnapshotVersion.
+	 */
+	static const uint32_t IndexSnapshotLayout =
+		static_cast<uint32_t>(sizeof(ManifestFileEntry) | sizeof(FileTableEntry) << 8 | sizeof(FileTableAdditionalData) << 16 | sizeof(void *) << 24);
+
+	IndexSnapshotStamp IndexSnapshotStamp::ofManifest(const std::filesystem::path &manifestFilename, const std::vector<unsigned char> &manifestData) {
+		IndexSnapshotStamp stamp;
+		stamp.manifestSize = manifestData.size();
+		stamp.manifestModificationTime = static_cast<int64_t>(std::filesystem::last_write_time(manifestFilename).time_since_epoch().count());
+		stamp.manifestCRC32 = fileCRC32(manifestData.data(), manifestData.size());
+
+		return stamp;
+	}
+
+	bool operator ==(const IndexSnapshotStamp &a, const IndexSnapshotStamp &b) {
+		return
+			a.manifestSize == b.manifestSize &&
+			a.manifestModificationTime == b.manifestModificationTime &&
+			a.manifestCRC32 == b.manifestCRC32;
+	}
+
+	bool operator !=(const IndexSnapshotStamp &a, const IndexSnapshotStamp &b) {
+		return !(a == b);
+	}
+
+	static SerializationStream &operator <<(SerializationStream &stream, const IndexSnapshotStamp &stamp) {
+		return stream << stamp.manifestSize << stamp.manifestModificationTime << stamp.manifestCRC32;
+	}
+
+	static SerializationStream &operator >>(SerializationStream &stream, IndexSnapshotStamp &stamp) {
+		return stream >> stamp.manifestSize >> stamp.manifestModificationTime >> stamp.manifestCRC32;
+	}
+
+	std::filesystem::path manifestSnapshotFilename(const std::filesystem::path &manifestFilename) {
+		auto filename = manifestFilename;
+		filename += ".esoidx";
+
+		return filename;
+	}
+
+	std::filesystem::path fileTableSnapshotFilename(const std::filesystem::path &manifestFilename, uint64_t fileTableKey) {
+		std::stringstream name;
+		name << manifestFilename.stem().u8string() << "." << std::hex << fileTableKey << ".esoidx";
+
+		return manifestFilename.parent_path() / std::filesystem::u8path(name.str());
+	}
+
+	/*
+	 * The reader receives the file as storage when the snapshot is mapped,
+	 * so that it may keep using the mapped data; otherwise, storage is null
+	 * and the data is gone once the reader returns.
+	 */
+	static bool readSnapshot(const std::filesystem::path &filename, IndexSnapshotKind kind, const std::function<bool(InputSerializationStream &stream, const std::shared_ptr<const void> &storage)> &reader) {
+		try {
+			std::error_code error;
+			auto size = std::filesystem::file_size(filename, error);
+			if (error || size == 0)
+				return false;
+
+			auto file = ArchiveDataFile::open(filename, ArchiveIOBackend::Default);
+
+			std::shared_ptr<const void> storage;
+			std::vector<unsigned char> buffer;
+			auto data = file->mappedRegion(0, static_cast<size_t>(size));
+			if (data) {
+				storage = file;
+			}
+			else {
+				buffer.resize(static_cast<size_t>(size));
+				file->read(0, buffer.data(), buffer.size());
+				data = buffer.data();
+			}
+
+			InputSerializationStream stream(data, data + size);
+
+			uint32_t signature, version, layout, bodyCRC32;
+			IndexSnapshotKind snapshotKind;
+			stream >> signature >> version >> layout >> snapshotKind >> bodyCRC32;
+
+			if (signature != IndexSnapshotSignature || version != IndexSnapshotVersion || layout != IndexSnapshotLayout || snapshotKind != kind)
+				return false;
+
+			// Nothing in the body is used unless all of it is intact.
+			auto bodyPosition = stream.getCurrentPosition();
+			if (fileCRC32(data + bodyPosition, static_cast<size_t>(size - bodyPosition)) != bodyCRC32)
+				return false;
+
+			return reader(stream, storage) && stream.getCurrentPosition() == size;
+		}
+		catch (const std::exception &) {
+			return false;
+		}
+	}
+
+	static void writeSnapshot(const std::filesystem::path &filename, IndexSnapshotKind kind, const std::function<void(OutputSerializationStream &stream)> &writer) {
+		try {
+			OutputSerializationStream stream;
+			stream << static_cast<uint32_t>(IndexSnapshotSignature) << static_cast<uint32_t>(IndexSnapshotVersion) << IndexSnapshotLayout << kind;
+
+			auto bodyCRC32Position = stream.getCurrentPosition();
+			stream << static_cast<uint32_t>(0);
+
+			auto bodyPosition = stream.getCurrentPosition();
+			writer(stream);
+
+			auto bodySize = stream.getCurrentPosition() - bodyPosition;
+			stream.setCurrentPosition(bodyPosition);
+			auto bodyCRC32 = fileCRC32(stream.getRegionForRead(bodySize), bodySize);
+
+			stream.setCurrentPosition(bodyCRC32Position);
+			stream << bodyCRC32;
+
+			writeWholeFileAtomically(filename, stream.data());
+		}
+		catch (const std::exception &) {
+
+		}
+	}
+
+	bool readManifestSnapshot(const std::filesystem::path &filename, const IndexSnapshotStamp &stamp, bool needPreciseSizes, MNFFile &manifest, FlatIndex<ManifestFileEntry> &index) {
+		return readSnapshot(filename, IndexSnapshotKind::Manifest, [&](InputSerializationStream &stream, const std::shared_ptr<const void> &storage) {
+			IndexSnapshotStamp snapshotStamp;
+			uint8_t preciseSizes;
+
+			stream >> snapshotStamp >> preciseSizes;
+
+			if (snapshotStamp != stamp || (needPreciseSizes && !preciseSizes))
+				return false;
+
+			stream
+				>> manifest.version
+				>> manifest.dataFileCountOld
+				>> manifest.dataFileCountNew
+				>> manifest.fileFlags
+				>> manifest.body.data.signature;
+
+			manifest.body.data.outer = &manifest;
+			index.readRaw(stream, storage);
+
+			return true;
+		});
+	}
+
+	void writeManifestSnapshot(const std::filesystem::path &filename, const IndexSnapshotStamp &stamp, bool preciseSizes, const MNFFile &manifest, const FlatIndex<ManifestFileEntry> &index) {
+		writeSnapshot(filename, IndexSnapshotKind::Manifest, [&](OutputSerializationStream &stream) {
+			stream
+				<< stamp
+				<< static_cast<uint8_t>(preciseSizes)
+				<< manifest.version
+				<< manifest.dataFileCountOld
+				<< manifest.dataFileCountNew
+				<< manifest.fileFlags
+				<< manifest.body.data.signature;
+
+			index.writeRaw(stream);
+		});
+	}
+
+	bool readFileTableSnapshot(const std::filesystem::path &filename, const ManifestFileEntry &source, FileTable &table) {
+		return readSnapshot(filename, IndexSnapshotKind::FileTable, [&](InputSerializationStream &stream, const std::shared_ptr<const void> &) {
+			uint32_t uncompressedSize, compressedSize, fileCRC32;
+			stream >> uncompressedSize >> compressedSize >> fileCRC32;
+
+			if (uncompressedSize != source.uncompressedSize || compressedSize != source.compressedSize || fileCRC32 != source.fileCRC32)
+				return false;
+
+			stream
+				>> table.unknown1
+				>> table.unknown2
+				>> table.unknown3
+				>> table.recordCount;
+
+			table.nameHashToLocalId.readRaw(stream);
+			table.entries.readRaw(stream);
+			table.additionalData.readRaw(stream);
+			readRawVector(stream, table.nameHeap);
+
+			// Names are looked up by offset into the heap without further checks.
+			for (const auto &entry : table.entries) {
+				if (entry.second.nameOffset > table.nameHeap.size())
+					return false;
+			}
+
+			return true;
+		});
+	}
+
+	void writeFileTableSnapshot(const std::filesystem::path &filename, const ManifestFileEntry &source, const FileTable &table) {
+		writeSnapshot(filename, IndexSnapshotKind::FileTable, [&](OutputSerializationStream &stream) {
+			stream
+				<< source.uncompressedSize
+				<< source.compressedSize
+				<< source.fileCRC32
+				<< table.unknown1
+				<< table.unknown2
+				<< table.unknown3
+				<< table.recordCount;
+
+			table.nameHashToLocalId.writeRaw(stream);
+			table.entries.writeRaw(stream);
+			table.additionalData.writeRaw(stream);
+			writeRawVector(stream, table.nameHeap);
+		});
+	}
+}
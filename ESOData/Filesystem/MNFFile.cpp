@@ -2,11 +2,14 @@
 
 #include <ESOData/Serialization/SerializationStream.h>
 
+#ifdef _WIN32
 #include <ESOData/Cryptography/CNGKey.h>
 #include <ESOData/Cryptography/CNGAlgorithmProvider.h>
 #include <ESOData/Cryptography/CNGHash.h>
+#endif
 
 #include <stdexcept>
+#include <limits>
 
 namespace esodata {
 	bool MNFFile::hasNewDataFileCount() const {
@@ -1,6 +1,9 @@
 #include <ESOData/Filesystem/ManifestFileEntry.h>
 
 #include <ESOData/Serialization/SerializationStream.h>
+#include <ESOData/Serialization/Byteswap.h>
+
+#include <string.h>
 
 namespace esodata {
 
@@ -9,8 +12,8 @@ namespace esodata {
 			<< entry.compressedSize
 			<< entry.fileCRC32
 			<< entry.fileOffset
-			<< entry.compressionType
 			<< entry.archiveIndex
+			<< entry.compressionType
 			<< entry.unknown;
 
 		return stream;
@@ -28,4 +31,34 @@ namespace esodata {
 
 		return stream;
 	}
+
+	SerializationStream &operator >>(SerializationStream &stream, std::vector<ManifestFileEntry> &entries) {
+		static const size_t SerializedEntrySize = 20;
+
+		static_assert(offsetof(ManifestFileEntry, uncompressedSize) == 0 && offsetof(ManifestFileEntry, fileOffset) == 3 * sizeof(uint32_t),
+			"the leading fields of ManifestFileEntry must be laid out as serialized");
+
+		if (entries.empty())
+			return stream;
+
+		auto region = stream.getRegionForRead(entries.size() * SerializedEntrySize);
+		auto swap = stream.swapEndian();
+
+		for (auto &entry : entries) {
+			auto leadingFields = reinterpret_cast<unsigned char *>(&entry);
+			memcpy(leadingFields, region, 4 * sizeof(uint32_t));
+			entry.archiveIndex = region[16];
+			entry.compressionType = static_cast<FileCompressionType>(region[17]);
+			memcpy(&entry.unknown, region + 18, sizeof(entry.unknown));
+
+			if (swap) {
+				byteswapArray(leadingFields, 4 * sizeof(uint32_t), sizeof(uint32_t));
+				byteswapArray(reinterpret_cast<unsigned char *>(&entry.unknown), sizeof(entry.unknown), sizeof(entry.unknown));
+			}
+
+			region += SerializedEntrySize;
+		}
+
+		return stream;
+	}
 }
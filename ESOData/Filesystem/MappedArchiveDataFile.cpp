@@ -0,0 +1,90 @@
+#include <ESOData/Filesystem/MappedArchiveDataFile.h>
+
+#include <stdexcept>
+#include <system_error>
+#include <algorithm>
+
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace esodata {
+#ifdef _WIN32
+	MappedArchiveDataFile::MappedArchiveDataFile(const std::filesystem::path &filename) : m_data(nullptr), m_size(0) {
+		(void)filename;
+
+		throw std::logic_error("memory-mapped archive I/O is not supported on this platform");
+	}
+
+	MappedArchiveDataFile::~MappedArchiveDataFile() = default;
+#else
+	MappedArchiveDataFile::MappedArchiveDataFile(const std::filesystem::path &filename) : m_data(nullptr), m_size(0) {
+		int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			throw std::system_error(errno, std::generic_category(), "open");
+
+		struct stat info;
+		if (fstat(fd, &info) < 0) {
+			int error = errno;
+			::close(fd);
+			throw std::system_error(error, std::generic_category(), "fstat");
+		}
+
+		m_size = static_cast<size_t>(info.st_size);
+
+		if (m_size != 0) {
+			auto mapping = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (mapping == MAP_FAILED) {
+				int error = errno;
+				::close(fd);
+				throw std::system_error(error, std::generic_category(), "mmap");
+			}
+
+			m_data = static_cast<const unsigned char *>(mapping);
+		}
+
+		::close(fd);
+	}
+
+	MappedArchiveDataFile::~MappedArchiveDataFile() {
+		if (m_data)
+			munmap(const_cast<unsigned char *>(m_data), m_size);
+	}
+#endif
+
+	void MappedArchiveDataFile::read(uint64_t offset, unsigned char *data, size_t size) const {
+		memcpy(data, mappedRegion(offset, size), size);
+	}
+
+	const unsigned char *MappedArchiveDataFile::mappedRegion(uint64_t offset, size_t size) const {
+		if (offset > m_size || size > m_size - offset)
+			throw std::runtime_error("short read");
+
+		return m_data + offset;
+	}
+
+	void MappedArchiveDataFile::prefetch(uint64_t offset, size_t size) const {
+#ifdef _WIN32
+		(void)offset;
+		(void)size;
+#else
+		if (offset >= m_size || size == 0)
+			return;
+
+		size = static_cast<size_t>(std::min<uint64_t>(size, m_size - offset));
+
+		static const uintptr_t PageMask = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)) - 1;
+
+		auto begin = reinterpret_cast<uintptr_t>(m_data + offset) & ~PageMask;
+		auto end = reinterpret_cast<uintptr_t>(m_data + offset + size);
+
+		madvise(reinterpret_cast<void *>(begin), end - begin, MADV_WILLNEED);
+#endif
+	}
+}
@@ -0,0 +1,94 @@
+#include <ESOData/Filesystem/SynchronousArchiveDataFile.h>
+
+#include <stdexcept>
+#include <system_error>
+
+#ifdef _WIN32
+#include <archiveparse/WindowsError.h>
+
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+namespace esodata {
+#ifdef _WIN32
+	static archiveparse::WindowsHandle openDataFile(const std::filesystem::path &filename) {
+		auto rawHandle = CreateFile(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
+		if (rawHandle == INVALID_HANDLE_VALUE)
+			throw archiveparse::WindowsError();
+
+		return archiveparse::WindowsHandle(rawHandle);
+	}
+
+	SynchronousArchiveDataFile::SynchronousArchiveDataFile(const std::filesystem::path &filename) : m_handle(openDataFile(filename)) {
+
+	}
+
+	SynchronousArchiveDataFile::~SynchronousArchiveDataFile() = default;
+
+	void SynchronousArchiveDataFile::read(uint64_t offset, unsigned char *data, size_t size) const {
+		OVERLAPPED overlapped;
+		ZeroMemory(&overlapped, sizeof(overlapped));
+		overlapped.Offset = static_cast<DWORD>(offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+		DWORD bytesRead;
+		if (!ReadFile(m_handle.get(), data, static_cast<DWORD>(size), &bytesRead, &overlapped))
+			throw archiveparse::WindowsError();
+
+		if (bytesRead != size)
+			throw std::runtime_error("short read");
+	}
+
+	void SynchronousArchiveDataFile::prefetch(uint64_t offset, size_t size) const {
+		/*
+		 * There is no non-blocking readahead hint for an unmapped handle.
+		 */
+		(void)offset;
+		(void)size;
+	}
+#else
+	SynchronousArchiveDataFile::SynchronousArchiveDataFile(const std::filesystem::path &filename) {
+		m_fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+		if (m_fd < 0)
+			throw std::system_error(errno, std::generic_category(), "open");
+	}
+
+	SynchronousArchiveDataFile::~SynchronousArchiveDataFile() {
+		::close(m_fd);
+	}
+
+	void SynchronousArchiveDataFile::read(uint64_t offset, unsigned char *data, size_t size) const {
+		while (size != 0) {
+			auto result = ::pread(m_fd, data, size, static_cast<off_t>(offset));
+			if (result < 0) {
+				if (errno == EINTR)
+					continue;
+
+				throw std::system_error(errno, std::generic_category(), "pread");
+			}
+
+			if (result == 0)
+				throw std::runtime_error("short read");
+
+			data += result;
+			size -= static_cast<size_t>(result);
+			offset += static_cast<uint64_t>(result);
+		}
+	}
+
+	void SynchronousArchiveDataFile::prefetch(uint64_t offset, size_t size) const {
+		posix_fadvise(m_fd, static_cast<off_t>(offset), static_cast<off_t>(size), POSIX_FADV_WILLNEED);
+	}
+#endif
+
+	const unsigned char *SynchronousArchiveDataFile::mappedRegion(uint64_t offset, size_t size) const {
+		(void)offset;
+		(void)size;
+
+		return nullptr;
+	}
+}
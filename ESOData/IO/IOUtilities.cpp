@@ -1,8 +1,8 @@
 #include <ESOData/IO/IOUtilities.h>
 
-#include <archiveparse/EncodingUtilities.h>
-
 #include <fstream>
+#include <sstream>
+#include <random>
 
 namespace esodata {
 	std::vector<unsigned char> readWholeFile(const std::filesystem::path &filename) {
@@ -19,4 +19,33 @@ namespace esodata {
 
 		return data;
 	}
+
+	void writeWholeFileAtomically(const std::filesystem::path &filename, const std::vector<unsigned char> &data) {
+		/*
+		 * Several processes may be writing the same file at once, so each
+		 * one gets its own temporary.
+		 */
+		std::stringstream suffix;
+		suffix << "." << std::hex << std::random_device()() << ".tmp";
+
+		auto temporaryFilename = filename;
+		temporaryFilename += suffix.str();
+
+		try {
+			{
+				std::ofstream stream;
+				stream.exceptions(std::ios::failbit | std::ios::eofbit | std::ios::badbit);
+				stream.open(temporaryFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+				stream.write(reinterpret_cast<const char *>(data.data()), data.size());
+			}
+
+			std::filesystem::rename(temporaryFilename, filename);
+		}
+		catch (...) {
+			std::error_code error;
+			std::filesystem::remove(temporaryFilename, error);
+
+			throw;
+		}
+	}
 }
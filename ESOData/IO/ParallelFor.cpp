@@ -0,0 +1,151 @@
+#include <ESOData/IO/ParallelFor.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace esodata {
+	namespace {
+		struct ParallelJob {
+			ParallelJob(size_t count, const std::function<void(size_t index)> &body) : count(count), body(body), nextIndex(0), closed(false), activeHelpers(0) {
+
+			}
+
+			void run() {
+				for (size_t index; (index = nextIndex.fetch_add(1)) < count; ) {
+					try {
+						body(index);
+					}
+					catch (...) {
+						std::unique_lock<std::mutex> locker(mutex);
+						if (!error)
+							error = std::current_exception();
+
+						nextIndex = count;
+					}
+				}
+			}
+
+			size_t count;
+			const std::function<void(size_t index)> &body;
+			std::atomic<size_t> nextIndex;
+
+			/*
+			 * Once the job is closed, helpers that have yet to start leave it
+			 * alone, as body is only valid while parallelFor is running.
+			 */
+			std::mutex mutex;
+			std::condition_variable helpersDone;
+			bool closed;
+			size_t activeHelpers;
+			std::exception_ptr error;
+		};
+
+		/*
+		 * Threads that help with parallelFor jobs, started on first use and
+		 * kept for the rest of the process. Jobs are queued once for every
+		 * helper they can use; a helper that dequeues a job which is already
+		 * finished simply moves on.
+		 */
+		class WorkerPool {
+		public:
+			WorkerPool() {
+				size_t threadCount = std::max(std::thread::hardware_concurrency(), 1U) - 1;
+
+				for (size_t index = 0; index < threadCount; index++) {
+					std::thread(&WorkerPool::workerLoop, this).detach();
+				}
+
+				m_threadCount = threadCount;
+			}
+
+			// Never destroyed, so that process exit doesn't have to wait for the workers.
+			static WorkerPool &shared() {
+				static WorkerPool *pool = new WorkerPool();
+				return *pool;
+			}
+
+			inline size_t threadCount() const {
+				return m_threadCount;
+			}
+
+			void submit(const std::shared_ptr<ParallelJob> &job, size_t helpers) {
+				{
+					std::unique_lock<std::mutex> locker(m_mutex);
+
+					for (size_t index = 0; index < helpers; index++) {
+						m_queue.push_back(job);
+					}
+				}
+
+				if (helpers == 1)
+					m_condition.notify_one();
+				else
+					m_condition.notify_all();
+			}
+
+		private:
+			void workerLoop() {
+				for (;;) {
+					std::shared_ptr<ParallelJob> job;
+
+					{
+						std::unique_lock<std::mutex> locker(m_mutex);
+						m_condition.wait(locker, [this]() { return !m_queue.empty(); });
+
+						job = std::move(m_queue.front());
+						m_queue.pop_front();
+					}
+
+					{
+						std::unique_lock<std::mutex> locker(job->mutex);
+						if (job->closed || job->nextIndex >= job->count)
+							continue;
+
+						job->activeHelpers++;
+					}
+
+					job->run();
+
+					{
+						std::unique_lock<std::mutex> locker(job->mutex);
+						if (--job->activeHelpers == 0)
+							job->helpersDone.notify_all();
+					}
+				}
+			}
+
+			size_t m_threadCount;
+			std::mutex m_mutex;
+			std::condition_variable m_condition;
+			std::deque<std::shared_ptr<ParallelJob>> m_queue;
+		};
+	}
+
+	void parallelFor(size_t count, const std::function<void(size_t index)> &body) {
+		if (count == 0)
+			return;
+
+		auto job = std::make_shared<ParallelJob>(count, body);
+
+		auto &pool = WorkerPool::shared();
+		auto helpers = std::min(pool.threadCount(), count - 1);
+		if (helpers != 0)
+			pool.submit(job, helpers);
+
+		job->run();
+
+		std::unique_lock<std::mutex> locker(job->mutex);
+		job->closed = true;
+		job->helpersDone.wait(locker, [&]() { return job->activeHelpers == 0; });
+
+		if (job->error)
+			std::rethrow_exception(job->error);
+	}
+}
@@ -1,8 +1,13 @@
-#include <Windows.h>
 #include "oodle.h"
 #include <stdio.h>
 #include <string>
+
+#ifdef _WIN32
+#include <Windows.h>
 #include <libloaderapi.h>
+#else
+#include <dlfcn.h>
+#endif
 
 namespace esodata {
 
@@ -12,16 +17,57 @@ namespace esodata {
 
 	bool LoadOodleLib() 
 	{
+#ifndef _WIN32
+		/*
+		 * The game doesn't ship a Linux build of Oodle, but the SDK one works
+		 * just as well if it's installed somewhere on the library path.
+		 */
+		void *mod = nullptr;
+		for (auto name : { "liboo2corelinux64.so.9", "liboo2corelinux64.so.8", "liboo2corelinux64.so" }) {
+			mod = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+			if (mod)
+				break;
+		}
+
+		/*
+		 * Failures are left to the caller to report; entries that need Oodle
+		 * fail with CodecUnavailableError anyway.
+		 */
+		if (mod == nullptr)
+			return false;
+
+		auto compressFunc = (OodleLZ_Compress_Func *) dlsym(mod, "OodleLZ_Compress");
+		auto decompressFunc = (OodleLZ_Decompress_Func *) dlsym(mod, "OodleLZ_Decompress");
+
+		if (!compressFunc || !decompressFunc) {
+			dlclose(mod);
+
+			g_OodleCompressFunc = nullptr;
+			g_OodleDecompressFunc = nullptr;
+
+			return false;
+		}
+
+		g_OodleCompressFunc = compressFunc;
+		g_OodleDecompressFunc = decompressFunc;
+#else
 		HINSTANCE mod = LoadLibraryA("oo2core_8_win64.dll");
 
-		if (mod == NULL) printf("Failed to load Oodle DLL!\n");
+		if (mod == NULL) {
+			printf("Failed to load Oodle DLL!\n");
+			return false;
+		}
 
 		g_OodleCompressFunc = (OodleLZ_Compress_Func *) GetProcAddress(mod, "OodleLZ_Compress");
 		g_OodleDecompressFunc = (OodleLZ_Decompress_Func *) GetProcAddress(mod, "OodleLZ_Decompress");
 
-		if (!g_OodleCompressFunc || !g_OodleDecompressFunc) printf("Failed to find Oodle compress/decompress functions in DLL!\n");
+		if (!g_OodleCompressFunc || !g_OodleDecompressFunc) {
+			printf("Failed to find Oodle compress/decompress functions in DLL!\n");
+			return false;
+		}
+#endif
 
 		return true;
 	}
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,180 @@
+#include <ESOData/Serialization/Byteswap.h>
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ESODATA_BYTESWAP_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(ESODATA_BYTESWAP_X86) && !defined(_MSC_VER)
+#define ESODATA_BYTESWAP_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ESODATA_BYTESWAP_TARGET(isa)
+#endif
+
+namespace esodata {
+	/*
+	 * Elements are moved through memcpy, which compiles to plain loads and
+	 * stores, so that unaligned buffers are handled and the loops remain
+	 * simple enough for the compiler to vectorize.
+	 */
+	template<typename T, T (*Swap)(T)>
+	static void byteswapElements(unsigned char *data, size_t count) {
+		for (size_t index = 0; index < count; index++) {
+			T value;
+			memcpy(&value, data + index * sizeof(T), sizeof(T));
+			value = Swap(value);
+			memcpy(data + index * sizeof(T), &value, sizeof(T));
+		}
+	}
+
+	static void byteswapScalar(unsigned char *data, size_t dataSize, size_t width) {
+		switch (width) {
+		case 2:
+			byteswapElements<uint16_t, byteswap16>(data, dataSize / 2);
+			break;
+
+		case 4:
+			byteswapElements<uint32_t, byteswap32>(data, dataSize / 4);
+			break;
+
+		case 8:
+			byteswapElements<uint64_t, byteswap64>(data, dataSize / 8);
+			break;
+		}
+	}
+
+#ifdef ESODATA_BYTESWAP_X86
+	/*
+	 * The vector kernels reverse each width-byte lane with a byte shuffle,
+	 * 16 bytes at a time with SSSE3 and 32 with AVX2. Whatever is left over
+	 * goes through the scalar loop. The kernels are compiled for their
+	 * instruction set regardless of the compiler flags and are only called
+	 * once the CPU is known to support it.
+	 */
+	ESODATA_BYTESWAP_TARGET("ssse3")
+	static __m128i byteswapShuffleMask(size_t width) {
+		alignas(16) unsigned char mask[16];
+		for (size_t index = 0; index < sizeof(mask); index++) {
+			mask[index] = static_cast<unsigned char>(index - index % width + (width - 1 - index % width));
+		}
+
+		return _mm_load_si128(reinterpret_cast<const __m128i *>(mask));
+	}
+
+	ESODATA_BYTESWAP_TARGET("ssse3")
+	static void byteswapSSSE3(unsigned char *data, size_t dataSize, size_t width) {
+		auto mask = byteswapShuffleMask(width);
+
+		size_t offset = 0;
+		for (; offset + 16 <= dataSize; offset += 16) {
+			auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + offset));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(data + offset), _mm_shuffle_epi8(block, mask));
+		}
+
+		byteswapScalar(data + offset, dataSize - offset, width);
+	}
+
+	ESODATA_BYTESWAP_TARGET("avx2")
+	static void byteswapAVX2(unsigned char *data, size_t dataSize, size_t width) {
+		auto mask = _mm256_broadcastsi128_si256(byteswapShuffleMask(width));
+
+		size_t offset = 0;
+		for (; offset + 64 <= dataSize; offset += 64) {
+			auto first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + offset));
+			auto second = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + offset + 32));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(data + offset), _mm256_shuffle_epi8(first, mask));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(data + offset + 32), _mm256_shuffle_epi8(second, mask));
+		}
+
+		for (; offset + 32 <= dataSize; offset += 32) {
+			auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + offset));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(data + offset), _mm256_shuffle_epi8(block, mask));
+		}
+
+		byteswapScalar(data + offset, dataSize - offset, width);
+	}
+
+	enum class ByteswapKernel {
+		Scalar,
+		SSSE3,
+		AVX2
+	};
+
+	static ByteswapKernel detectByteswapKernel() {
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		auto maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		bool ssse3 = (info[2] & (1 << 9)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+
+		bool avx2 = false;
+		if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+#else
+		__builtin_cpu_init();
+		bool ssse3 = __builtin_cpu_supports("ssse3");
+		bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+		if (avx2)
+			return ByteswapKernel::AVX2;
+		else if (ssse3)
+			return ByteswapKernel::SSSE3;
+		else
+			return ByteswapKernel::Scalar;
+	}
+#endif
+
+	// Below this size, the scalar loop is at least as fast as the vector kernels.
+	static const size_t VectorByteswapMinimumSize = 32;
+
+	void byteswapArray(unsigned char *data, size_t dataSize, size_t width) {
+		switch (width) {
+		case 0:
+		case 1:
+			break;
+
+		case 2:
+		case 4:
+		case 8:
+#ifdef ESODATA_BYTESWAP_X86
+			if (dataSize >= VectorByteswapMinimumSize) {
+				static const ByteswapKernel kernel = detectByteswapKernel();
+
+				switch (kernel) {
+				case ByteswapKernel::AVX2:
+					byteswapAVX2(data, dataSize, width);
+					return;
+
+				case ByteswapKernel::SSSE3:
+					byteswapSSSE3(data, dataSize, width);
+					return;
+
+				case ByteswapKernel::Scalar:
+					break;
+				}
+			}
+#endif
+
+			byteswapScalar(data, dataSize, width);
+			break;
+
+		default:
+			for (size_t offset = 0; offset + width <= dataSize; offset += width) {
+				std::reverse(data + offset, data + offset + width);
+			}
+			break;
+		}
+	}
+}
@@ -0,0 +1,270 @@
+#include <ESOData/Serialization/CRC32.h>
+
+#include <array>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ESODATA_CRC32_CLMUL 1
+
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ESODATA_CRC32_CLMUL_TARGET
+#else
+#define ESODATA_CRC32_CLMUL_TARGET __attribute__((target("pclmul,sse4.1")))
+#endif
+#endif
+
+namespace esodata {
+	/*
+	 * All implementations below operate on the raw register, without the
+	 * inversions applied by crc32Update.
+	 */
+
+	typedef std::array<std::array<uint32_t, 256>, 8> CRC32Tables;
+
+	static CRC32Tables buildCRC32Tables() {
+		CRC32Tables tables;
+
+		for (uint32_t byte = 0; byte < 256; byte++) {
+			uint32_t crc = byte;
+
+			for (int bit = 0; bit < 8; bit++) {
+				crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1)));
+			}
+
+			tables[0][byte] = crc;
+		}
+
+		for (size_t slice = 1; slice < tables.size(); slice++) {
+			for (size_t byte = 0; byte < 256; byte++) {
+				auto previous = tables[slice - 1][byte];
+				tables[slice][byte] = (previous >> 8) ^ tables[0][previous & 0xFF];
+			}
+		}
+
+		return tables;
+	}
+
+	static const CRC32Tables &crc32Tables() {
+		static const CRC32Tables tables = buildCRC32Tables();
+
+		return tables;
+	}
+
+	static inline uint32_t loadLittleEndian32(const unsigned char *data) {
+		return
+			static_cast<uint32_t>(data[0]) |
+			static_cast<uint32_t>(data[1]) << 8 |
+			static_cast<uint32_t>(data[2]) << 16 |
+			static_cast<uint32_t>(data[3]) << 24;
+	}
+
+	static uint32_t crc32SliceBy8(uint32_t crc, const unsigned char *data, size_t dataSize) {
+		const auto &tables = crc32Tables();
+
+		while (dataSize >= 8) {
+			uint32_t low = loadLittleEndian32(data) ^ crc;
+			uint32_t high = loadLittleEndian32(data + 4);
+
+			crc =
+				tables[7][low & 0xFF] ^
+				tables[6][(low >> 8) & 0xFF] ^
+				tables[5][(low >> 16) & 0xFF] ^
+				tables[4][low >> 24] ^
+				tables[3][high & 0xFF] ^
+				tables[2][(high >> 8) & 0xFF] ^
+				tables[1][(high >> 16) & 0xFF] ^
+				tables[0][high >> 24];
+
+			data += 8;
+			dataSize -= 8;
+		}
+
+		while (dataSize != 0) {
+			crc = (crc >> 8) ^ tables[0][(crc ^ *data) & 0xFF];
+
+			data++;
+			dataSize--;
+		}
+
+		return crc;
+	}
+
+#ifdef ESODATA_CRC32_CLMUL
+	/*
+	 * Folding with PCLMULQDQ, after Intel's "Fast CRC Computation for Generic
+	 * Polynomials Using PCLMULQDQ Instruction". The constants are the
+	 * bit-reflected x^(k) mod P values for the fold distances used below, and
+	 * the Barrett reduction constants for P. dataSize must be a multiple of 16,
+	 * and at least 64.
+	 */
+	ESODATA_CRC32_CLMUL_TARGET static uint32_t crc32Fold(uint32_t crc, const unsigned char *data, size_t dataSize) {
+		alignas(16) static const uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+		alignas(16) static const uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+		alignas(16) static const uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+		alignas(16) static const uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+
+		__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+		x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 0x00));
+		x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 0x10));
+		x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 0x20));
+		x4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 0x30));
+
+		x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+
+		x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k1k2));
+
+		data += 64;
+		dataSize -= 64;
+
+		// Fold four lanes in parallel, 64 bytes at a time.
+		while (dataSize >= 64) {
+			x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+			x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+			x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+			x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+			x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+			x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+			y5 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 0x00));
+			y6 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 0x10));
+			y7 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 0x20));
+			y8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 0x30));
+
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+			x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+			x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+			x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+			data += 64;
+			dataSize -= 64;
+		}
+
+		// Fold the four lanes into one.
+		x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k3k4));
+
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+		// Fold the remaining 16 byte blocks.
+		while (dataSize >= 16) {
+			x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+
+			x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+			data += 16;
+			dataSize -= 16;
+		}
+
+		// Reduce 128 bits to 64.
+		x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+		x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+		x1 = _mm_srli_si128(x1, 8);
+		x1 = _mm_xor_si128(x1, x2);
+
+		x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(k5k0));
+
+		x2 = _mm_srli_si128(x1, 4);
+		x1 = _mm_and_si128(x1, x3);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_xor_si128(x1, x2);
+
+		// Barrett reduction to 32 bits.
+		x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(poly));
+
+		x2 = _mm_and_si128(x1, x3);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+		x2 = _mm_and_si128(x2, x3);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x1 = _mm_xor_si128(x1, x2);
+
+		return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+	}
+
+	static bool cpuSupportsCRC32Fold() {
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 1);
+
+		const int SSE41 = 1 << 19;
+		const int PCLMULQDQ = 1 << 1;
+
+		return (info[2] & (SSE41 | PCLMULQDQ)) == (SSE41 | PCLMULQDQ);
+#else
+		return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+	}
+
+	static uint32_t crc32Accelerated(uint32_t crc, const unsigned char *data, size_t dataSize) {
+		/*
+		 * Below this size, the setup and reduction of the folding path
+		 * outweigh its throughput.
+		 */
+		const size_t MinimumFoldSize = 256;
+
+		if (dataSize >= MinimumFoldSize) {
+			size_t foldSize = dataSize & ~static_cast<size_t>(15);
+
+			crc = crc32Fold(crc, data, foldSize);
+
+			data += foldSize;
+			dataSize -= foldSize;
+		}
+
+		return crc32SliceBy8(crc, data, dataSize);
+	}
+#endif
+
+	typedef uint32_t (*CRC32Implementation)(uint32_t crc, const unsigned char *data, size_t dataSize);
+
+	static CRC32Implementation selectCRC32Implementation() {
+#ifdef ESODATA_CRC32_CLMUL
+		if (cpuSupportsCRC32Fold())
+			return crc32Accelerated;
+#endif
+
+		return crc32SliceBy8;
+	}
+
+	static CRC32Implementation crc32Implementation() {
+		static const CRC32Implementation implementation = selectCRC32Implementation();
+
+		return implementation;
+	}
+
+	uint32_t crc32Update(uint32_t crc, const unsigned char *data, size_t dataSize) {
+		return ~crc32Implementation()(~crc, data, dataSize);
+	}
+
+	uint32_t crc32UpdatePortable(uint32_t crc, const unsigned char *data, size_t dataSize) {
+		return ~crc32SliceBy8(~crc, data, dataSize);
+	}
+
+	bool crc32UsesFolding() {
+		return crc32Implementation() != crc32SliceBy8;
+	}
+
+	uint32_t fileCRC32(const unsigned char *data, size_t dataSize) {
+		return crc32Implementation()(0, data, dataSize);
+	}
+
+	uint32_t fileCRC32Update(uint32_t checksum, const unsigned char *data, size_t dataSize) {
+		return crc32Implementation()(checksum, data, dataSize);
+	}
+}
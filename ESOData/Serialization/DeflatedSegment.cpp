@@ -1,4 +1,8 @@
 #include <ESOData/Serialization/DeflatedSegment.h>
+#include <ESOData/Serialization/Inflate.h>
+#include <ESOData/Serialization/CRC32.h>
+
+#include <ESOData/IO/ParallelFor.h>
 
 #include <zlib.h>
 
@@ -19,6 +23,19 @@ namespace esodata {
 	}
 
 	std::vector<unsigned char> zlibCompress(const unsigned char *inputData, size_t inputLength) {
+		std::vector<unsigned char> output(zlibCompressBound(inputLength));
+
+		output.resize(zlibCompress(inputData, inputLength, output.data(), output.size()));
+		output.shrink_to_fit();
+
+		return output;
+	}
+
+	size_t zlibCompressBound(size_t inputLength) {
+		return compressBound(static_cast<uLong>(inputLength));
+	}
+
+	size_t zlibCompress(const unsigned char *inputData, size_t inputLength, unsigned char *outputData, size_t outputLength) {
 		struct ManagedStream : z_stream {
 			ManagedStream() {
 				zalloc = zlibAlloc;
@@ -35,25 +52,20 @@ namespace esodata {
 			}
 		} stream;
 
-		std::vector<unsigned char> output(deflateBound(&stream, inputLength));
-
 		stream.next_in = inputData;
 		stream.avail_in = inputLength;
-		stream.next_out = output.data();
-		stream.avail_out = output.size();
+		stream.next_out = outputData;
+		stream.avail_out = outputLength;
 
 		int result = deflate(&stream, Z_FINISH);
 
 		if (result != Z_STREAM_END || stream.avail_in != 0)
 			throw std::runtime_error("zlib error");
 
-		output.resize(stream.total_out);
-		output.shrink_to_fit();
-
-		return output;
+		return stream.total_out;
 	}
 
-	void zlibUncompress(const unsigned char *inputData, size_t inputLength, unsigned char *outputData, size_t outputLength) {
+	static void zlibInflate(const unsigned char *inputData, size_t inputLength, unsigned char *outputData, size_t outputLength) {
 		struct ManagedStream : z_stream {
 			ManagedStream() {
 				zalloc = zlibAlloc;
@@ -81,4 +93,38 @@ namespace esodata {
 			throw std::runtime_error("zlib error");
 	}
 
-}
\ No newline at end of file
+	void zlibUncompress(const unsigned char *inputData, size_t inputLength, unsigned char *outputData, size_t outputLength) {
+		if (inflateWholeBuffer(inputData, inputLength, outputData, outputLength))
+			return;
+
+		zlibInflate(inputData, inputLength, outputData, outputLength);
+	}
+
+	uint32_t zlibUncompressAndChecksum(const unsigned char *inputData, size_t inputLength, unsigned char *outputData, size_t outputLength) {
+		uint32_t checksum;
+		if (inflateWholeBuffer(inputData, inputLength, outputData, outputLength, &checksum))
+			return checksum;
+
+		zlibInflate(inputData, inputLength, outputData, outputLength);
+
+		return fileCRC32(outputData, outputLength);
+	}
+
+	DeflatedSegmentBatch::DeflatedSegmentBatch() = default;
+
+	DeflatedSegmentBatch::~DeflatedSegmentBatch() = default;
+
+	void DeflatedSegmentBatch::decode() {
+		auto segments = std::move(m_segments);
+		m_segments.clear();
+
+		if (segments.size() == 1) {
+			segments.front()();
+		}
+		else {
+			parallelFor(segments.size(), [&segments](size_t index) {
+				segments[index]();
+			});
+		}
+	}
+}
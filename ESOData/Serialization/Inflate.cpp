@@ -0,0 +1,565 @@
+#include <ESOData/Serialization/Inflate.h>
+#include <ESOData/Serialization/CRC32.h>
+
+#include <zlib.h>
+
+#include <array>
+#include <algorithm>
+#include <limits>
+
+#include <stdint.h>
+#include <string.h>
+
+namespace esodata {
+	/*
+	 * Huffman codes are decoded with a primary table indexed by the next
+	 * PrimaryBits bits of input, or fewer if the longest code is shorter, as
+	 * filling the table dominates for small blocks. Longer codes continue in
+	 * a subtable that the primary entry links to.
+	 */
+	static const unsigned LiteralLengthPrimaryBits = 10;
+	static const unsigned DistancePrimaryBits = 8;
+	static const unsigned CodeLengthPrimaryBits = 7;
+	static const unsigned MaxCodeLength = 15;
+
+	static const unsigned LiteralLengthSymbolCount = 288;
+	static const unsigned DistanceSymbolCount = 32;
+	static const unsigned CodeLengthSymbolCount = 19;
+
+	// Primary table, plus a full-size subtable for every code that could need one.
+	static const size_t LiteralLengthTableSize =
+		(size_t(1) << LiteralLengthPrimaryBits) + LiteralLengthSymbolCount * (size_t(1) << (MaxCodeLength - LiteralLengthPrimaryBits));
+	static const size_t DistanceTableSize =
+		(size_t(1) << DistancePrimaryBits) + DistanceSymbolCount * (size_t(1) << (MaxCodeLength - DistancePrimaryBits));
+
+	enum : uint8_t {
+		EntryLiteral = 0x00,
+		EntryBase = 0x10, // Low nibble is the number of extra bits.
+		EntryEndOfBlock = 0x20,
+		EntryLink = 0x40, // Low nibble is the number of subtable index bits.
+		EntryInvalid = 0x80
+	};
+
+	struct HuffmanEntry {
+		uint16_t value;
+		uint8_t length;
+		uint8_t op;
+	};
+
+	static const uint16_t LengthBase[29] = {
+		3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+	};
+
+	static const uint8_t LengthExtraBits[29] = {
+		0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+	};
+
+	static const uint16_t DistanceBase[30] = {
+		1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+		8193, 12289, 16385, 24577
+	};
+
+	static const uint8_t DistanceExtraBits[30] = {
+		0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+	};
+
+	static const uint8_t CodeLengthOrder[CodeLengthSymbolCount] = {
+		16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+	};
+
+	struct BitReversalTable {
+		std::array<uint8_t, 256> bytes{};
+
+		constexpr BitReversalTable() {
+			for (unsigned value = 0; value < 256; value++) {
+				unsigned reversed = 0;
+				for (unsigned bit = 0; bit < 8; bit++) {
+					reversed |= ((value >> bit) & 1) << (7 - bit);
+				}
+
+				bytes[value] = static_cast<uint8_t>(reversed);
+			}
+		}
+
+		constexpr unsigned operator [](unsigned value) const {
+			return bytes[value];
+		}
+	};
+
+	static constexpr BitReversalTable BitReversal;
+
+	static HuffmanEntry literalLengthSymbol(unsigned symbol) {
+		if (symbol < 256)
+			return HuffmanEntry{ static_cast<uint16_t>(symbol), 0, EntryLiteral };
+		else if (symbol == 256)
+			return HuffmanEntry{ 0, 0, EntryEndOfBlock };
+		else if (symbol < 286)
+			return HuffmanEntry{ LengthBase[symbol - 257], 0, static_cast<uint8_t>(EntryBase | LengthExtraBits[symbol - 257]) };
+		else
+			return HuffmanEntry{ 0, 0, EntryInvalid };
+	}
+
+	static HuffmanEntry distanceSymbol(unsigned symbol) {
+		if (symbol < 30)
+			return HuffmanEntry{ DistanceBase[symbol], 0, static_cast<uint8_t>(EntryBase | DistanceExtraBits[symbol]) };
+		else
+			return HuffmanEntry{ 0, 0, EntryInvalid };
+	}
+
+	static HuffmanEntry codeLengthSymbol(unsigned symbol) {
+		return HuffmanEntry{ static_cast<uint16_t>(symbol), 0, EntryLiteral };
+	}
+
+	/*
+	 * Builds the decoding table for a canonical Huffman code, and returns the
+	 * number of bits the primary table is indexed with in primaryBits. Only
+	 * complete codes are accepted; zlib's encoder never produces anything
+	 * else.
+	 */
+	template<HuffmanEntry (*SymbolEntry)(unsigned symbol)>
+	static bool buildHuffmanTable(const uint8_t *lengths, unsigned symbolCount, unsigned maxPrimaryBits, HuffmanEntry *table, unsigned &primaryBits) {
+		/*
+		 * Most symbols are usually unused. Gathering the used ones without
+		 * branching first keeps the passes below free of mispredictions.
+		 */
+		std::array<uint16_t, LiteralLengthSymbolCount> used;
+		unsigned usedCount = 0;
+		for (unsigned symbol = 0; symbol < symbolCount; symbol++) {
+			used[usedCount] = static_cast<uint16_t>(symbol);
+			usedCount += lengths[symbol] != 0;
+		}
+
+		std::array<unsigned, MaxCodeLength + 1> count{};
+		for (unsigned index = 0; index < usedCount; index++) {
+			count[lengths[used[index]]]++;
+		}
+
+		int left = 1;
+		unsigned maxLength = 0;
+		for (unsigned length = 1; length <= MaxCodeLength; length++) {
+			left = (left << 1) - static_cast<int>(count[length]);
+			if (left < 0)
+				return false;
+
+			if (count[length] != 0)
+				maxLength = length;
+		}
+
+		if (left != 0)
+			return false;
+
+		std::array<unsigned, MaxCodeLength + 1> nextCode;
+		unsigned code = 0;
+		for (unsigned length = 1; length <= MaxCodeLength; length++) {
+			code = (code + count[length - 1]) << 1;
+			nextCode[length] = code;
+		}
+
+		primaryBits = std::min(maxLength, maxPrimaryBits);
+
+		unsigned primarySize = 1U << primaryBits;
+		unsigned subtableBits = maxLength > primaryBits ? maxLength - primaryBits : 0;
+		unsigned nextSubtable = primarySize;
+
+		if (subtableBits != 0)
+			std::fill(table, table + primarySize, HuffmanEntry{ 0, 0, EntryInvalid });
+
+		for (unsigned index = 0; index < usedCount; index++) {
+			unsigned symbol = used[index];
+			unsigned length = lengths[symbol];
+			unsigned symbolCode = nextCode[length]++;
+			unsigned reversed = ((BitReversal[symbolCode & 0xFF] << 8) | BitReversal[symbolCode >> 8]) >> (16 - length);
+
+			auto entry = SymbolEntry(symbol);
+
+			if (length <= primaryBits) {
+				entry.length = static_cast<uint8_t>(length);
+
+				for (unsigned index = reversed; index < primarySize; index += 1U << length) {
+					table[index] = entry;
+				}
+			}
+			else {
+				auto &link = table[reversed & (primarySize - 1)];
+				if (link.op == EntryInvalid) {
+					link = HuffmanEntry{ static_cast<uint16_t>(nextSubtable), static_cast<uint8_t>(primaryBits), static_cast<uint8_t>(EntryLink | subtableBits) };
+					nextSubtable += 1U << subtableBits;
+				}
+
+				auto subtable = table + link.value;
+				entry.length = static_cast<uint8_t>(length - primaryBits);
+
+				for (unsigned index = reversed >> primaryBits; index < (1U << subtableBits); index += 1U << entry.length) {
+					subtable[index] = entry;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	struct FixedTables {
+		std::array<HuffmanEntry, size_t(1) << LiteralLengthPrimaryBits> literalLength;
+		std::array<HuffmanEntry, size_t(1) << DistancePrimaryBits> distance;
+		unsigned literalLengthBits;
+		unsigned distanceBits;
+
+		FixedTables() {
+			std::array<uint8_t, LiteralLengthSymbolCount> literalLengthLengths;
+			std::fill(literalLengthLengths.begin(), literalLengthLengths.begin() + 144, 8);
+			std::fill(literalLengthLengths.begin() + 144, literalLengthLengths.begin() + 256, 9);
+			std::fill(literalLengthLengths.begin() + 256, literalLengthLengths.begin() + 280, 7);
+			std::fill(literalLengthLengths.begin() + 280, literalLengthLengths.end(), 8);
+
+			std::array<uint8_t, DistanceSymbolCount> distanceLengths;
+			std::fill(distanceLengths.begin(), distanceLengths.end(), 5);
+
+			buildHuffmanTable<literalLengthSymbol>(literalLengthLengths.data(), LiteralLengthSymbolCount, LiteralLengthPrimaryBits, literalLength.data(), literalLengthBits);
+			buildHuffmanTable<distanceSymbol>(distanceLengths.data(), DistanceSymbolCount, DistancePrimaryBits, distance.data(), distanceBits);
+		}
+	};
+
+	static const FixedTables &fixedTables() {
+		static const FixedTables tables;
+
+		return tables;
+	}
+
+	struct DynamicTables {
+		std::array<HuffmanEntry, LiteralLengthTableSize> literalLength;
+		std::array<HuffmanEntry, DistanceTableSize> distance;
+		unsigned literalLengthBits;
+		unsigned distanceBits;
+	};
+
+	static thread_local DynamicTables InflateDynamicTables;
+
+	static inline uint64_t loadLittleEndian64(const unsigned char *data) {
+		uint64_t value;
+		memcpy(&value, data, sizeof(value));
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		value = __builtin_bswap64(value);
+#endif
+
+		return value;
+	}
+
+	/*
+	 * Keeps at least 56 bits buffered after every refill, so that a whole
+	 * length/distance pair can be decoded without refilling in between. Bits
+	 * past the end of the input read as zero and are counted in overrun.
+	 */
+	struct BitReader {
+		const unsigned char *position;
+		const unsigned char *end;
+		uint64_t buffer;
+		unsigned count;
+		size_t overrun;
+
+		BitReader(const unsigned char *position, const unsigned char *end) : position(position), end(end), buffer(0), count(0), overrun(0) {
+
+		}
+
+		inline void refill() {
+			if (end - position >= 8) {
+				buffer |= loadLittleEndian64(position) << count;
+				position += (63 - count) >> 3;
+				count |= 56;
+			}
+			else {
+				while (count < 56) {
+					if (position != end)
+						buffer |= static_cast<uint64_t>(*position++) << count;
+					else
+						overrun++;
+
+					count += 8;
+				}
+			}
+		}
+
+		inline unsigned peek(unsigned bits) const {
+			return static_cast<unsigned>(buffer & ((uint64_t(1) << bits) - 1));
+		}
+
+		inline void consume(unsigned bits) {
+			buffer >>= bits;
+			count -= bits;
+		}
+
+		inline unsigned read(unsigned bits) {
+			auto value = peek(bits);
+			consume(bits);
+			return value;
+		}
+
+		/*
+		 * Drops the bits up to the next byte boundary and hands the buffered
+		 * bytes back to the input. Returns false if bits past the end of the
+		 * input have been consumed.
+		 */
+		bool alignToByte() {
+			consume(count & 7);
+
+			size_t buffered = count >> 3;
+			if (overrun > buffered)
+				return false;
+
+			position -= buffered - overrun;
+			buffer = 0;
+			count = 0;
+			overrun = 0;
+
+			return true;
+		}
+
+		// A valid stream never consumes more than the 8 bytes of padding a refill may add.
+		inline bool overran() const {
+			return overrun > 8;
+		}
+	};
+
+	static inline HuffmanEntry decodeSymbol(BitReader &reader, const HuffmanEntry *table, unsigned primaryBits) {
+		auto entry = table[reader.peek(primaryBits)];
+		if (entry.op & EntryLink) {
+			reader.consume(primaryBits);
+			entry = table[entry.value + reader.peek(entry.op & 0x0F)];
+		}
+
+		reader.consume(entry.length);
+
+		return entry;
+	}
+
+	static inline void copyMatch(unsigned char *output, size_t distance, size_t length, const unsigned char *outputEnd) {
+		const unsigned char *source = output - distance;
+
+		if (distance >= 8 && static_cast<size_t>(outputEnd - output) >= length + 8) {
+			auto end = output + length;
+
+			do {
+				memcpy(output, source, 8);
+				output += 8;
+				source += 8;
+			} while (output < end);
+		}
+		else if (distance == 1) {
+			memset(output, *source, length);
+		}
+		else {
+			while (length-- != 0) {
+				*output++ = *source++;
+			}
+		}
+	}
+
+	template<typename Tables>
+	static bool inflateHuffmanBlock(BitReader &reader, const Tables &tables, unsigned char *outputStart, unsigned char *&output, unsigned char *outputEnd) {
+
+		for (;;) {
+			reader.refill();
+			if (reader.overran())
+				return false;
+
+			auto entry = decodeSymbol(reader, tables.literalLength.data(), tables.literalLengthBits);
+
+			if (entry.op == EntryLiteral) {
+				if (output == outputEnd)
+					return false;
+
+				*output++ = static_cast<unsigned char>(entry.value);
+				continue;
+			}
+
+			if (entry.op == EntryEndOfBlock)
+				return true;
+
+			if ((entry.op & 0xF0) != EntryBase)
+				return false;
+
+			size_t length = entry.value + reader.read(entry.op & 0x0F);
+
+			auto distanceEntry = decodeSymbol(reader, tables.distance.data(), tables.distanceBits);
+			if ((distanceEntry.op & 0xF0) != EntryBase)
+				return false;
+
+			size_t distance = distanceEntry.value + reader.read(distanceEntry.op & 0x0F);
+
+			if (distance > static_cast<size_t>(output - outputStart) || length > static_cast<size_t>(outputEnd - output))
+				return false;
+
+			copyMatch(output, distance, length, outputEnd);
+			output += length;
+		}
+	}
+
+	static bool readDynamicTables(BitReader &reader, DynamicTables &tables) {
+		reader.refill();
+
+		unsigned literalLengthCount = reader.read(5) + 257;
+		unsigned distanceCount = reader.read(5) + 1;
+		unsigned codeLengthCount = reader.read(4) + 4;
+
+		if (literalLengthCount > 286 || distanceCount > 30)
+			return false;
+
+		std::array<uint8_t, CodeLengthSymbolCount> codeLengthLengths{};
+		for (unsigned index = 0; index < codeLengthCount; index++) {
+			reader.refill();
+			codeLengthLengths[CodeLengthOrder[index]] = static_cast<uint8_t>(reader.read(3));
+		}
+
+		std::array<HuffmanEntry, size_t(1) << CodeLengthPrimaryBits> codeLengthTable;
+		unsigned codeLengthBits;
+		if (!buildHuffmanTable<codeLengthSymbol>(codeLengthLengths.data(), CodeLengthSymbolCount, CodeLengthPrimaryBits, codeLengthTable.data(), codeLengthBits))
+			return false;
+
+		std::array<uint8_t, 286 + 30> lengths;
+		unsigned totalCount = literalLengthCount + distanceCount;
+
+		for (unsigned index = 0; index < totalCount;) {
+			reader.refill();
+			if (reader.overran())
+				return false;
+
+			auto symbol = decodeSymbol(reader, codeLengthTable.data(), codeLengthBits).value;
+
+			if (symbol < 16) {
+				lengths[index++] = static_cast<uint8_t>(symbol);
+				continue;
+			}
+
+			uint8_t value = 0;
+			unsigned repeat;
+
+			if (symbol == 16) {
+				if (index == 0)
+					return false;
+
+				value = lengths[index - 1];
+				repeat = 3 + reader.read(2);
+			}
+			else if (symbol == 17) {
+				repeat = 3 + reader.read(3);
+			}
+			else {
+				repeat = 11 + reader.read(7);
+			}
+
+			if (repeat > totalCount - index)
+				return false;
+
+			std::fill(lengths.begin() + index, lengths.begin() + index + repeat, value);
+			index += repeat;
+		}
+
+		if (lengths[256] == 0)
+			return false;
+
+		return
+			buildHuffmanTable<literalLengthSymbol>(lengths.data(), literalLengthCount, LiteralLengthPrimaryBits, tables.literalLength.data(), tables.literalLengthBits) &&
+			buildHuffmanTable<distanceSymbol>(lengths.data() + literalLengthCount, distanceCount, DistancePrimaryBits, tables.distance.data(), tables.distanceBits);
+	}
+
+	static uLong adler32Update(uLong checksum, const unsigned char *data, size_t dataSize) {
+		while (dataSize != 0) {
+			auto chunk = static_cast<uInt>(std::min<size_t>(dataSize, std::numeric_limits<uInt>::max()));
+			checksum = adler32(checksum, data, chunk);
+			data += chunk;
+			dataSize -= chunk;
+		}
+
+		return checksum;
+	}
+
+	bool inflateWholeBuffer(const unsigned char *inputData, size_t inputLength, unsigned char *outputData, size_t outputLength, uint32_t *outputChecksum) {
+		if (inputLength < 6)
+			return false;
+
+		unsigned header = (static_cast<unsigned>(inputData[0]) << 8) | inputData[1];
+		if ((inputData[0] & 0x0F) != Z_DEFLATED || (inputData[0] >> 4) > 7 || header % 31 != 0 || (inputData[1] & 0x20) != 0)
+			return false;
+
+		/*
+		 * The Adler-32 trailer must be the last four bytes of the input, so
+		 * the compressed blocks end right before it.
+		 */
+		auto trailer = inputData + inputLength - 4;
+		BitReader reader(inputData + 2, trailer);
+
+		auto output = outputData;
+		auto outputEnd = outputData + outputLength;
+		bool finalBlock;
+
+		uLong adler = adler32(0, Z_NULL, 0);
+		uint32_t checksum = 0;
+		auto checksummed = outputData;
+
+		do {
+			reader.refill();
+
+			finalBlock = reader.read(1) != 0;
+			unsigned type = reader.read(2);
+
+			if (type == 0) {
+				if (!reader.alignToByte() || reader.end - reader.position < 4)
+					return false;
+
+				auto position = reader.position;
+				unsigned length = position[0] | (position[1] << 8);
+				unsigned lengthComplement = position[2] | (position[3] << 8);
+				position += 4;
+
+				if (length != (~lengthComplement & 0xFFFF) ||
+					static_cast<size_t>(reader.end - position) < length ||
+					static_cast<size_t>(outputEnd - output) < length)
+					return false;
+
+				// Empty outputs may have no storage at all.
+				if (length != 0)
+					memcpy(output, position, length);
+
+				output += length;
+				reader.position = position + length;
+			}
+			else if (type == 1) {
+				if (!inflateHuffmanBlock(reader, fixedTables(), outputData, output, outputEnd))
+					return false;
+			}
+			else if (type == 2) {
+				auto &tables = InflateDynamicTables;
+
+				if (!readDynamicTables(reader, tables) ||
+					!inflateHuffmanBlock(reader, tables, outputData, output, outputEnd))
+					return false;
+			}
+			else {
+				return false;
+			}
+
+			adler = adler32Update(adler, checksummed, output - checksummed);
+			if (outputChecksum)
+				checksum = fileCRC32Update(checksum, checksummed, output - checksummed);
+
+			checksummed = output;
+		} while (!finalBlock);
+
+		if (!reader.alignToByte() || reader.position != trailer || output != outputEnd)
+			return false;
+
+		uint32_t expectedChecksum =
+			static_cast<uint32_t>(trailer[0]) << 24 |
+			static_cast<uint32_t>(trailer[1]) << 16 |
+			static_cast<uint32_t>(trailer[2]) << 8 |
+			static_cast<uint32_t>(trailer[3]);
+
+		if (static_cast<uint32_t>(adler) != expectedChecksum)
+			return false;
+
+		if (outputChecksum)
+			*outputChecksum = checksum;
+
+		return true;
+	}
+}
@@ -11,6 +11,10 @@ namespace esodata {
 
 	}
 
+	OutputSerializationStream::OutputSerializationStream(std::vector<unsigned char> &&buffer) : m_data(std::move(buffer)), m_targetStream(nullptr), m_position(0), m_offset(0) {
+		m_data.clear();
+	}
+
 	OutputSerializationStream::~OutputSerializationStream() = default;
 
 	unsigned char *OutputSerializationStream::getRegionForWrite(size_t size) {
@@ -0,0 +1,32 @@
+#include <ESOData/Serialization/ScratchBuffer.h>
+
+namespace esodata {
+	// Released buffers with a larger capacity are freed instead of pooled.
+	static const size_t MaxPooledScratchSize = 64 * 1024 * 1024;
+
+	// Enough for the deepest nesting of segments in any of the formats.
+	static const size_t MaxPooledScratchBuffers = 8;
+
+	static thread_local std::vector<std::vector<unsigned char>> scratchPool;
+
+	ScratchBuffer::ScratchBuffer() {
+		if (!scratchPool.empty()) {
+			m_storage = std::move(scratchPool.back());
+			scratchPool.pop_back();
+		}
+	}
+
+	ScratchBuffer::~ScratchBuffer() {
+		if (m_storage.capacity() != 0 && m_storage.capacity() <= MaxPooledScratchSize && scratchPool.size() < MaxPooledScratchBuffers) {
+			scratchPool.emplace_back(std::move(m_storage));
+		}
+	}
+
+	unsigned char *ScratchBuffer::data(size_t size) {
+		// Only grow the vector, so that already initialized bytes are reused as-is.
+		if (m_storage.size() < size)
+			m_storage.resize(size);
+
+		return m_storage.data();
+	}
+}
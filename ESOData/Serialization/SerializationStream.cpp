@@ -1,7 +1,10 @@
 #include <ESOData/Serialization/SerializationStream.h>
+#include <ESOData/Serialization/Byteswap.h>
 
 #include <algorithm>
 
+#include <string.h>
+
 namespace esodata {
 	SerializationStream::SerializationStream() : m_swapEndian(false) {
 
@@ -9,10 +12,38 @@ namespace esodata {
 
 	SerializationStream::~SerializationStream() = default;
 
+	template<typename T>
+	static inline void copyReversedScalar(const unsigned char *source, unsigned char *destination) {
+		T value;
+		memcpy(&value, source, sizeof(value));
+		value = byteswapValue(value);
+		memcpy(destination, &value, sizeof(value));
+	}
+
+	static void copyReversed(const unsigned char *source, unsigned char *destination, size_t dataSize) {
+		switch (dataSize) {
+		case 2:
+			copyReversedScalar<uint16_t>(source, destination);
+			break;
+
+		case 4:
+			copyReversedScalar<uint32_t>(source, destination);
+			break;
+
+		case 8:
+			copyReversedScalar<uint64_t>(source, destination);
+			break;
+
+		default:
+			std::reverse_copy(source, source + dataSize, destination);
+			break;
+		}
+	}
+
 	void SerializationStream::writeArithmetic(const unsigned char *data, size_t dataSize) {
 		if (m_swapEndian) {
 			auto interim = getRegionForWrite(dataSize);
-			std::reverse_copy(data, data + dataSize, interim);
+			copyReversed(data, interim, dataSize);
 		}
 		else {
 			writeData(data, dataSize);
@@ -22,7 +53,7 @@ namespace esodata {
 	void SerializationStream::readArithmetic(unsigned char *data, size_t dataSize) {
 		if (m_swapEndian) {
 			auto interim = getRegionForRead(dataSize);
-			std::reverse_copy(interim, interim + dataSize, data);
+			copyReversed(interim, data, dataSize);
 		}
 		else {
 			readData(data, dataSize);
@@ -32,7 +63,7 @@ namespace esodata {
 	void SerializationStream::writeFloat(const unsigned char* data, size_t dataSize) {
 		if (!m_swapEndian) {
 			auto interim = getRegionForWrite(dataSize);
-			std::reverse_copy(data, data + dataSize, interim);
+			copyReversed(data, interim, dataSize);
 		}
 		else {
 			writeData(data, dataSize);
@@ -42,7 +73,7 @@ namespace esodata {
 	void SerializationStream::readFloat(unsigned char* data, size_t dataSize) {
 		if (!m_swapEndian) {
 			auto interim = getRegionForRead(dataSize);
-			std::reverse_copy(interim, interim + dataSize, data);
+			copyReversed(interim, data, dataSize);
 		}
 		else {
 			readData(data, dataSize);
@@ -50,13 +81,37 @@ namespace esodata {
 	}
 
 	void SerializationStream::writeData(const unsigned char *data, size_t dataSize) {
+		if (dataSize == 0)
+			return;
+
 		auto region = getRegionForWrite(dataSize);
 		memcpy(region, data, dataSize);
 	}
 
 	void SerializationStream::readData(unsigned char *data, size_t dataSize) {
+		if (dataSize == 0)
+			return;
+
+		auto region = getRegionForRead(dataSize);
+		memcpy(data, region, dataSize);
+	}
+
+	void SerializationStream::writeBlock(const unsigned char *data, size_t dataSize, size_t swapWidth) {
+		if (dataSize == 0)
+			return;
+
+		auto region = getRegionForWrite(dataSize);
+		memcpy(region, data, dataSize);
+		byteswapArray(region, dataSize, swapWidth);
+	}
+
+	void SerializationStream::readBlock(unsigned char *data, size_t dataSize, size_t swapWidth) {
+		if (dataSize == 0)
+			return;
+
 		auto region = getRegionForRead(dataSize);
 		memcpy(data, region, dataSize);
+		byteswapArray(data, dataSize, swapWidth);
 	}
 
 	template<>
@@ -130,7 +185,7 @@ namespace esodata {
 
 	template<>
 	SerializationStream& operator >><bool>(SerializationStream& stream, std::vector<bool>& value) {
-		for (auto& val : value) {
+		for (auto&& val : value) {
 			bool boolVal;
 			stream >> boolVal;
 			val = boolVal;
@@ -2,12 +2,287 @@
 
 #include <ESOData/Filesystem/Filesystem.h>
 
-#include <ESOData/Serialization/InputSerializationStream.h>
+#include <ESOData/Serialization/FastInputReader.h>
 #include <ESOData/Serialization/SizedVector.h>
 
 #include <stdexcept>
 
 namespace esodata {
+	/*
+	 * The fixed-size structures of fixture files are described once by the
+	 * visitFields overloads below, which enumerate their scalar fields in
+	 * serialized order. Fixture files are read through FastInputReader, one
+	 * bounds check per array of structures; the SerializationStream
+	 * operators share the same description.
+	 */
+	using FixtureFileReader = FastInputReader<false>;
+
+	template<typename Visitor>
+	static void visitFields(FixtureFileVector &obj, Visitor &&visitor) {
+		visitor(obj.x);
+		visitor(obj.y);
+		visitor(obj.z);
+	}
+
+	template<typename Visitor>
+	static void visitFields(FixtureFileBaseObject &obj, Visitor &&visitor) {
+		visitor(obj.fixtureID);
+		visitor(obj.flags);
+		visitor(obj.itemGroupID);
+		visitFields(obj.rotation, visitor);
+		visitFields(obj.translation, visitor);
+		visitor(obj.worldOffsetX);
+		visitor(obj.unknown12);
+		visitor(obj.worldOffsetY);
+	}
+
+	template<typename Visitor>
+	static void visitFields(FixtureFilePlacedObject &obj, Visitor &&visitor) {
+		visitFields(static_cast<FixtureFileBaseObject &>(obj), visitor);
+
+		visitor(obj.unknown14);
+		visitor(obj.room);
+		visitor(obj.unknown16);
+		visitor(obj.unknown17);
+		visitor(obj.model);
+		visitor(obj.clickable);
+		visitor(obj.unknown20);
+		visitor(obj.unknown21);
+		visitor(obj.unknown22);
+		visitor(obj.unknown23);
+		visitor(obj.unknown24);
+	}
+
+	template<typename Visitor>
+	static void visitFields(FixtureFileLightSource &obj, Visitor &&visitor) {
+		visitFields(static_cast<FixtureFileBaseObject &>(obj), visitor);
+
+		visitor(obj.unknown14);
+		visitor(obj.unknown15);
+		visitor(obj.unknown16);
+		visitor(obj.unknown17);
+		visitor(obj.unknown18);
+		visitor(obj.unknown19);
+		visitor(obj.unknown20);
+		visitor(obj.unknown21);
+		visitor(obj.unknown22);
+		visitor(obj.unknown23);
+		visitor(obj.unknown24);
+		visitor(obj.unknown25);
+		visitor(obj.unknown26);
+		visitor(obj.unknown27);
+		visitor(obj.unknown28);
+		visitor(obj.unknown29);
+		visitor(obj.unknown30);
+		visitor(obj.unknown31);
+		visitor(obj.unknown32);
+		visitor(obj.unknown33);
+		visitor(obj.texture1);
+		visitor(obj.unknown35);
+		visitor(obj.unknown36);
+		visitor(obj.unknown37);
+		visitor(obj.unknown38);
+		visitor(obj.texture2);
+		visitor(obj.unknown40);
+		visitor(obj.unknown41);
+		visitor(obj.unknown42);
+		visitor(obj.unknown43);
+		visitor(obj.unknown44);
+		visitor(obj.unknown45);
+		visitor(obj.unknown46);
+		visitor(obj.unknown47);
+		visitor(obj.unknown48);
+		visitor(obj.unknown49);
+		visitor(obj.unknown50);
+		visitor(obj.unknown51);
+		visitor(obj.unknown52);
+		visitor(obj.unknown53);
+		visitor(obj.unknown54);
+		visitor(obj.unknown55);
+		visitor(obj.unknown56);
+		visitor(obj.unknown57);
+		visitor(obj.unknown58);
+		visitor(obj.unknown59);
+		visitor(obj.unknown60);
+		visitor(obj.unknown61);
+		visitor(obj.unknown62);
+		visitor(obj.unknown63);
+		visitor(obj.unknown64);
+		visitor(obj.unknown65);
+		visitor(obj.unknown66);
+		visitor(obj.unknown67);
+		visitor(obj.unknown68);
+		visitor(obj.unknown69);
+		visitor(obj.unknown70);
+		visitor(obj.unknown71);
+		visitor(obj.unknown72);
+		visitor(obj.unknown73);
+		visitor(obj.unknown74);
+		visitor(obj.unknown75);
+		visitor(obj.unknown76);
+		visitor(obj.unknown77);
+		visitor(obj.unknown78);
+	}
+
+	template<typename Visitor>
+	static void visitFields(FixtureFileUnknownObject &obj, Visitor &&visitor) {
+		visitFields(static_cast<FixtureFileBaseObject &>(obj), visitor);
+
+		visitor(obj.unknown14);
+		visitor(obj.unknown15);
+		visitor(obj.unknown16);
+		visitor(obj.unknown17);
+		visitor(obj.unknown18);
+		visitor(obj.unknown19);
+		visitor(obj.unknown20);
+		visitor(obj.unknown21);
+		visitor(obj.unknown22);
+	}
+
+	template<typename Visitor>
+	static void visitFields(FixtureFileRTreeBoundingBox &obj, Visitor &&visitor) {
+		visitFields(obj.min, visitor);
+		visitFields(obj.max, visitor);
+	}
+
+	template<typename Visitor>
+	static void visitFields(FixtureFileRTreeItemChild &obj, Visitor &&visitor) {
+		visitFields(obj.boundingBox, visitor);
+		visitor(obj.itemIndex);
+	}
+
+	template<typename Object>
+	static size_t serializedSize() {
+		Object obj{};
+		size_t size = 0;
+
+		visitFields(obj, [&](const auto &field) {
+			size += sizeof(field);
+		});
+
+		return size;
+	}
+
+	template<typename Object>
+	static void readStructure(SerializationStream &stream, Object &obj) {
+		visitFields(obj, [&](auto &field) {
+			stream >> field;
+		});
+	}
+
+	template<typename Object>
+	static void writeStructure(SerializationStream &stream, const Object &obj) {
+		visitFields(const_cast<Object &>(obj), [&](const auto &field) {
+			stream << field;
+		});
+	}
+
+	template<typename Object>
+	static void readStructure(FixtureFileReader &reader, Object &obj) {
+		static const size_t Size = serializedSize<Object>();
+
+		auto cursor = reader.fields(Size);
+		visitFields(obj, [&](auto &field) {
+			cursor >> field;
+		});
+	}
+
+	template<typename Object>
+	static void readStructures(SerializationStream &stream, std::vector<Object> &objects) {
+		stream >> makeSizedVector<uint32_t>(objects);
+	}
+
+	template<typename Object>
+	static void readStructures(FixtureFileReader &reader, std::vector<Object> &objects) {
+		static const size_t Size = serializedSize<Object>();
+
+		uint32_t count;
+		reader >> count;
+
+		auto cursor = reader.fields(Size, count);
+
+		objects.resize(count);
+		for (auto &obj : objects) {
+			visitFields(obj, [&](auto &field) {
+				cursor >> field;
+			});
+		}
+	}
+
+	template<typename Stream>
+	static void readRTreeNode(Stream &stream, FixtureFileRTreeNode &obj) {
+		stream >> obj.nodeLevelsBelow;
+
+		if (obj.isLeafNode()) {
+			readStructures(stream, obj.itemChildren);
+		}
+		else {
+			uint32_t count;
+			stream >> count;
+
+			obj.nodeChildren.resize(count);
+			for (auto &child : obj.nodeChildren) {
+				readStructure(stream, child.boundingBox);
+				readRTreeNode(stream, child.node);
+			}
+		}
+	}
+
+	template<typename Stream>
+	static void readRTree(Stream &stream, FixtureFileRTree &obj) {
+		stream >> obj.signature;
+		if (obj.signature != FixtureFileRTree::ExpectedSignature)
+			throw std::runtime_error("bad R-Tree signature");
+
+		stream
+			>> obj.unknown2
+			>> obj.unknown3
+			>> obj.unknown4
+			>> obj.unknown5
+			>> obj.unknown6
+			>> obj.unknown7;
+
+		if(obj.unknown2 != FixtureFileRTree::ExpectedUnknown2 ||
+			obj.unknown3 != FixtureFileRTree::ExpectedUnknown3 ||
+			obj.unknown4 != FixtureFileRTree::ExpectedUnknown4 ||
+			obj.unknown5 != FixtureFileRTree::ExpectedUnknown5 ||
+			obj.unknown6 != FixtureFileRTree::ExpectedUnknown6 ||
+			obj.unknown7 != FixtureFileRTree::ExpectedUnknown7)
+			throw std::runtime_error("bad R-Tree dimensions");
+
+		readRTreeNode(stream, obj.rootNode);
+	}
+
+	template<typename Stream>
+	static void readObjectGroup(Stream &stream, FixtureFileObjectGroup &obj) {
+		stream >>
+			obj.groupId >>
+			makeSizedVector<uint32_t>(obj.furnitureID);
+	}
+
+	template<typename Stream>
+	static void readFixtureFile(Stream &stream, FixtureFile &obj) {
+		stream >> obj.version;
+		if(obj.version != FixtureFile::ExpectedVersion)
+			throw std::runtime_error("Invalid FixtureFile version");
+
+		readStructures(stream, obj.placedObjects);
+		readStructures(stream, obj.lightSources);
+		readStructures(stream, obj.unknownObjects);
+
+		uint32_t groupCount;
+		stream >> groupCount;
+
+		obj.objectGroups.resize(groupCount);
+		for (auto &group : obj.objectGroups) {
+			readObjectGroup(stream, group);
+		}
+
+		readRTree(stream, obj.unknown5);
+		readRTree(stream, obj.unknown6);
+		readRTree(stream, obj.unknown7);
+		readRTree(stream, obj.unknown8);
+	}
 
 	std::unique_ptr<FixtureFile> FixtureFile::readFromFilesystem(const Filesystem &filesystem, uint64_t fileId) {
 		std::vector<unsigned char> data;
@@ -15,10 +290,10 @@ namespace esodata {
 		if (!filesystem.tryReadFileByKey(fileId, data))
 			return nullptr;
 
-		InputSerializationStream serializer(data.data(), data.data() + data.size());
+		FixtureFileReader reader(data.data(), data.data() + data.size());
 
 		auto instance = std::make_unique<FixtureFile>();
-		serializer >> *instance;
+		readFixtureFile(reader, *instance);
 
 		return instance;
 	}
@@ -36,19 +311,8 @@ namespace esodata {
 	}
 
 	SerializationStream &operator >>(SerializationStream &stream, FixtureFile &obj) {
-		stream >> obj.version;
-		if(obj.version != FixtureFile::ExpectedVersion)
-			throw std::runtime_error("Invalid FixtureFile version");
-
-		return stream
-			>> makeSizedVector<uint32_t>(obj.placedObjects)
-			>> makeSizedVector<uint32_t>(obj.lightSources)
-			>> makeSizedVector<uint32_t>(obj.unknownObjects)
-			>> makeSizedVector<uint32_t>(obj.objectGroups)
-			>> obj.unknown5
-			>> obj.unknown6
-			>> obj.unknown7
-			>> obj.unknown8;
+		readFixtureFile(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator <<(SerializationStream &stream, const FixtureFileRTree &obj) {
@@ -64,35 +328,18 @@ namespace esodata {
 	}
 
 	SerializationStream &operator >>(SerializationStream &stream, FixtureFileRTree &obj) {
-		stream >> obj.signature;
-		if (obj.signature != FixtureFileRTree::ExpectedSignature)
-			throw std::runtime_error("bad R-Tree signature");
-
-		stream
-			>> obj.unknown2
-			>> obj.unknown3
-			>> obj.unknown4
-			>> obj.unknown5
-			>> obj.unknown6
-			>> obj.unknown7;
-
-		if(obj.unknown2 != FixtureFileRTree::ExpectedUnknown2 ||
-			obj.unknown3 != FixtureFileRTree::ExpectedUnknown3 ||
-			obj.unknown4 != FixtureFileRTree::ExpectedUnknown4 ||
-			obj.unknown5 != FixtureFileRTree::ExpectedUnknown5 ||
-			obj.unknown6 != FixtureFileRTree::ExpectedUnknown6 ||
-			obj.unknown7 != FixtureFileRTree::ExpectedUnknown7)
-			throw std::runtime_error("bad R-Tree dimensions");
-
-		return stream >> obj.rootNode;
+		readRTree(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator <<(SerializationStream &stream, const FixtureFileRTreeItemChild &obj) {
-		return stream << static_cast<const FixtureFileRTreeBaseChild &>(obj) << obj.itemIndex;
+		writeStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator >>(SerializationStream &stream, FixtureFileRTreeItemChild &obj) {
-		return stream >> static_cast<FixtureFileRTreeBaseChild &>(obj) >> obj.itemIndex;
+		readStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator <<(SerializationStream &stream, const FixtureFileRTreeNodeChild &obj) {
@@ -125,24 +372,18 @@ namespace esodata {
 	}
 
 	SerializationStream &operator >>(SerializationStream &stream, FixtureFileRTreeNode &obj) {
-		stream >> obj.nodeLevelsBelow;
-
-		if (obj.isLeafNode()) {
-			stream >> makeSizedVector<uint32_t>(obj.itemChildren);
-		}
-		else {
-			stream >> makeSizedVector<uint32_t>(obj.nodeChildren);
-		}
-
+		readRTreeNode(stream, obj);
 		return stream;
 	}
 
 	SerializationStream &operator <<(SerializationStream &stream, const FixtureFileRTreeBoundingBox &obj) {
-		return stream << obj.min << obj.max;
+		writeStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator >>(SerializationStream &stream, FixtureFileRTreeBoundingBox &obj) {
-		return stream >> obj.min >> obj.max;
+		readStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator <<(SerializationStream &stream, const FixtureFileObjectGroup &obj) {
@@ -152,241 +393,58 @@ namespace esodata {
 	}
 
 	SerializationStream &operator >>(SerializationStream &stream, FixtureFileObjectGroup &obj) {
-		return stream >>
-			obj.groupId >>
-			makeSizedVector<uint32_t>(obj.furnitureID);
+		readObjectGroup(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator <<(SerializationStream &stream, const FixtureFileUnknownObject &obj) {
-		return stream
-			<< static_cast<const FixtureFileBaseObject &>(obj)
-			<< obj.unknown14
-			<< obj.unknown15
-			<< obj.unknown16
-			<< obj.unknown17
-			<< obj.unknown18
-			<< obj.unknown19
-			<< obj.unknown20
-			<< obj.unknown21
-			<< obj.unknown22;
+		writeStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator >>(SerializationStream &stream, FixtureFileUnknownObject &obj) {
-		return stream
-			>> static_cast<FixtureFileBaseObject &>(obj)
-			>> obj.unknown14
-			>> obj.unknown15
-			>> obj.unknown16
-			>> obj.unknown17
-			>> obj.unknown18
-			>> obj.unknown19
-			>> obj.unknown20
-			>> obj.unknown21
-			>> obj.unknown22;
+		readStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator <<(SerializationStream &stream, const FixtureFileLightSource &obj) {
-		return stream
-			<< static_cast<const FixtureFileBaseObject &>(obj)
-			<< obj.unknown14
-			<< obj.unknown15
-			<< obj.unknown16
-			<< obj.unknown17
-			<< obj.unknown18
-			<< obj.unknown19
-			<< obj.unknown20
-			<< obj.unknown21
-			<< obj.unknown22
-			<< obj.unknown23
-			<< obj.unknown24
-			<< obj.unknown25
-			<< obj.unknown26
-			<< obj.unknown27
-			<< obj.unknown28
-			<< obj.unknown29
-			<< obj.unknown30
-			<< obj.unknown31
-			<< obj.unknown32
-			<< obj.unknown33
-			<< obj.texture1
-			<< obj.unknown35
-			<< obj.unknown36
-			<< obj.unknown37
-			<< obj.unknown38
-			<< obj.texture2
-			<< obj.unknown40
-			<< obj.unknown41
-			<< obj.unknown42
-			<< obj.unknown43
-			<< obj.unknown44
-			<< obj.unknown45
-			<< obj.unknown46
-			<< obj.unknown47
-			<< obj.unknown48
-			<< obj.unknown49
-			<< obj.unknown50
-			<< obj.unknown51
-			<< obj.unknown52
-			<< obj.unknown53
-			<< obj.unknown54
-			<< obj.unknown55
-			<< obj.unknown56
-			<< obj.unknown57
-			<< obj.unknown58
-			<< obj.unknown59
-			<< obj.unknown60
-			<< obj.unknown61
-			<< obj.unknown62
-			<< obj.unknown63
-			<< obj.unknown64
-			<< obj.unknown65
-			<< obj.unknown66
-			<< obj.unknown67
-			<< obj.unknown68
-			<< obj.unknown69
-			<< obj.unknown70
-			<< obj.unknown71
-			<< obj.unknown72
-			<< obj.unknown73
-			<< obj.unknown74
-			<< obj.unknown75
-			<< obj.unknown76
-			<< obj.unknown77
-			<< obj.unknown78;
+		writeStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator >>(SerializationStream &stream, FixtureFileLightSource &obj) {
-		return stream
-			>> static_cast<FixtureFileBaseObject &>(obj)
-			>> obj.unknown14
-			>> obj.unknown15
-			>> obj.unknown16
-			>> obj.unknown17
-			>> obj.unknown18
-			>> obj.unknown19
-			>> obj.unknown20
-			>> obj.unknown21
-			>> obj.unknown22
-			>> obj.unknown23
-			>> obj.unknown24
-			>> obj.unknown25
-			>> obj.unknown26
-			>> obj.unknown27
-			>> obj.unknown28
-			>> obj.unknown29
-			>> obj.unknown30
-			>> obj.unknown31
-			>> obj.unknown32
-			>> obj.unknown33
-			>> obj.texture1
-			>> obj.unknown35
-			>> obj.unknown36
-			>> obj.unknown37
-			>> obj.unknown38
-			>> obj.texture2
-			>> obj.unknown40
-			>> obj.unknown41
-			>> obj.unknown42
-			>> obj.unknown43
-			>> obj.unknown44
-			>> obj.unknown45
-			>> obj.unknown46
-			>> obj.unknown47
-			>> obj.unknown48
-			>> obj.unknown49
-			>> obj.unknown50
-			>> obj.unknown51
-			>> obj.unknown52
-			>> obj.unknown53
-			>> obj.unknown54
-			>> obj.unknown55
-			>> obj.unknown56
-			>> obj.unknown57
-			>> obj.unknown58
-			>> obj.unknown59
-			>> obj.unknown60
-			>> obj.unknown61
-			>> obj.unknown62
-			>> obj.unknown63
-			>> obj.unknown64
-			>> obj.unknown65
-			>> obj.unknown66
-			>> obj.unknown67
-			>> obj.unknown68
-			>> obj.unknown69
-			>> obj.unknown70
-			>> obj.unknown71
-			>> obj.unknown72
-			>> obj.unknown73
-			>> obj.unknown74
-			>> obj.unknown75
-			>> obj.unknown76
-			>> obj.unknown77
-			>> obj.unknown78;
+		readStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator <<(SerializationStream &stream, const FixtureFilePlacedObject &obj) {
-		return stream
-			<< static_cast<const FixtureFileBaseObject &>(obj)
-			<< obj.unknown14
-			<< obj.room
-			<< obj.unknown16
-			<< obj.unknown17
-			<< obj.model
-			<< obj.clickable
-			<< obj.unknown20
-			<< obj.unknown21
-			<< obj.unknown22
-			<< obj.unknown23
-			<< obj.unknown24;
+		writeStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator >>(SerializationStream &stream, FixtureFilePlacedObject &obj) {
-		return stream
-			>> static_cast<FixtureFileBaseObject &>(obj)
-			>> obj.unknown14
-			>> obj.room
-			>> obj.unknown16
-			>> obj.unknown17
-			>> obj.model
-			>> obj.clickable
-			>> obj.unknown20
-			>> obj.unknown21
-			>> obj.unknown22
-			>> obj.unknown23
-			>> obj.unknown24;
+		readStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator <<(SerializationStream &stream, const FixtureFileBaseObject &obj) {
-		return stream
-			<< obj.fixtureID
-			<< obj.flags
-			<< obj.itemGroupID
-			<< obj.rotation
-			<< obj.translation
-			<< obj.worldOffsetX
-			<< obj.unknown12
-			<< obj.worldOffsetY;
+		writeStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator >>(SerializationStream &stream, FixtureFileBaseObject &obj) {
-		return stream
-			>> obj.fixtureID
-			>> obj.flags
-			>> obj.itemGroupID
-			>> obj.rotation
-			>> obj.translation
-			>> obj.worldOffsetX
-			>> obj.unknown12
-			>> obj.worldOffsetY;
+		readStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator <<(SerializationStream &stream, const FixtureFileVector &obj) {
-		return stream << obj.x << obj.y << obj.z;
+		writeStructure(stream, obj);
+		return stream;
 	}
 
 	SerializationStream &operator >>(SerializationStream &stream, FixtureFileVector &obj) {
-		return stream >> obj.x >> obj.y >> obj.z;
+		readStructure(stream, obj);
+		return stream;
 	}
 
 }
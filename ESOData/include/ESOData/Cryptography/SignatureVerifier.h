@@ -0,0 +1,43 @@
+#ifndef ESODATA_CRYPTOGRAPHY_SIGNATURE_VERIFIER_H
+#define ESODATA_CRYPTOGRAPHY_SIGNATURE_VERIFIER_H
+
+#include <stdint.h>
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace esodata {
+	/*
+	 * Verifies SHA-1 based file signatures. The signature is in the format
+	 * produced by CNG, that is, raw (r, s) for DSA and ECDSA keys and PKCS #1
+	 * v1.5 for RSA keys, and the public key is a DER-encoded
+	 * SubjectPublicKeyInfo.
+	 *
+	 * Imported keys are cached by their encoding, since nearly all files share
+	 * the same one, and hash state is kept per thread. verify may be called
+	 * concurrently. Uses CNG on Windows, and OpenSSL elsewhere.
+	 */
+	class SignatureVerifier {
+	public:
+		SignatureVerifier();
+		~SignatureVerifier();
+
+		SignatureVerifier(const SignatureVerifier &other) = delete;
+		SignatureVerifier &operator =(const SignatureVerifier &other) = delete;
+
+		bool verify(const std::vector<uint8_t> &publicKey, const unsigned char *data, size_t dataSize,
+			const std::vector<uint8_t> &signature);
+
+	private:
+		class Key;
+
+		std::shared_ptr<Key> importKey(const std::vector<uint8_t> &publicKey);
+
+		std::mutex m_keysMutex;
+		std::map<std::vector<uint8_t>, std::shared_ptr<Key>> m_keys;
+	};
+}
+
+#endif
@@ -2,8 +2,10 @@
 #define ESODATA_DATABASE_DEF_FILE_H
 
 #include <vector>
+#include <functional>
 
 #include <stdint.h>
+#include <stddef.h>
 
 namespace esodata {
 	class SerializationStream;
@@ -26,6 +28,13 @@ namespace esodata {
 
 		void readFromData(const std::vector<unsigned char>& data, size_t& offset);
 
+		/*
+		 * Same as readFromData, but decompresses the record into storage
+		 * returned by allocate, which is called once with the length of the
+		 * record, instead of recordData. Returns the length of the record.
+		 */
+		size_t readFromDataInto(const std::vector<unsigned char>& data, size_t& offset, const std::function<unsigned char*(size_t length)>& allocate);
+
 		friend SerializationStream& operator <<(SerializationStream& stream, const DefFileRow& value);
 		friend SerializationStream& operator >>(SerializationStream& stream, DefFileRow& value);
 	};
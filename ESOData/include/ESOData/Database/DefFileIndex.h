@@ -4,6 +4,8 @@
 #include <memory>
 #include <vector>
 
+#include <ESOData/Serialization/SerializationStream.h>
+
 namespace esodata {
 	class Filesystem;
 	class SerializationStream;
@@ -40,6 +42,15 @@ namespace esodata {
 	SerializationStream& operator <<(SerializationStream& stream, const DefFileIndex::LookupRecord& value);
 	SerializationStream& operator >>(SerializationStream& stream, DefFileIndex::LookupRecord& value);
 
+	template<>
+	struct BulkSerializable<DefFileIndex::LookupRecord> {
+		static constexpr bool value = true;
+		static constexpr size_t swapWidth = sizeof(uint32_t);
+		static constexpr bool floatingPoint = false;
+	};
+
+	static_assert(sizeof(DefFileIndex::LookupRecord) == 8, "LookupRecord must match its serialized form");
+
 }
 
 #endif
@@ -7,10 +7,16 @@
 #include <vector>
 #include <filesystem>
 #include <optional>
+#include <string>
+#include <unordered_set>
 
 namespace esodata {
 	class Filesystem;
 
+	/*
+	 * Defs are loaded when their records are first accessed. Loading is
+	 * safe to trigger from any number of threads at once.
+	 */
 	class ESODatabase {
 	public:
 		explicit ESODatabase(const Filesystem* fs);
@@ -22,10 +28,20 @@ namespace esodata {
 		inline const std::vector<ESODatabaseDef>& defs() const { return m_defs; }
 		inline std::vector<ESODatabaseDef>& defs() { return m_defs; }
 
-		void loadDirectives(std::filesystem::path& directoryPath);
+		void loadDirectives(const std::filesystem::path& directoryPath);
 
 		const ESODatabaseDef& findDefByName(const std::string& name) const;
 
+		/*
+		 * Loads the named defs ahead of use, in parallel, for callers that
+		 * would rather pay for loading up front. Defs that are already loaded
+		 * are skipped.
+		 */
+		void preload(const std::unordered_set<std::string>& names) const;
+
+		// Same as above, for all defs.
+		void preloadAll() const;
+
 	private:
 		const Filesystem* m_fs;
 		std::vector<ESODatabaseDef> m_defs;
@@ -2,16 +2,25 @@
 #define ESODATABASE_DATABASE_ESO_DATABASE_DEF_H
 
 #include <string>
+#include <memory>
 
 #include <ESOData/Database/ESODatabaseRecord.h>
 #include <ESOData/Directives/DatabaseDirectiveFile.h>
 
 namespace esodata {
 	class Filesystem;
-	class SerializationStream;
+
+	template<bool SwapEndian>
+	class FastInputReader;
 
 	struct ESODatabaseParsingContext;
 
+	/*
+	 * Records are loaded on first access through records() or
+	 * findRecordById, or by an explicit loadDef. Loading happens once, even
+	 * if several threads access the def at the same time; a load that
+	 * fails is attempted again on the next access.
+	 */
 	class ESODatabaseDef {
 	public:
 		ESODatabaseDef(const esodata::Filesystem* fs, const DatabaseDirectiveFile::Structure& def, const ESODatabaseParsingContext& parsingContext);
@@ -26,27 +35,61 @@ namespace esodata {
 		inline unsigned int id() const { return m_id; }
 		inline const std::string& name() const { return m_name; }
 
-		void loadDef();
+		bool retainStrings() const;
+
+		/*
+		 * When enabled, loadDef keeps the decompressed records, and string
+		 * fields are parsed as std::string_view values pointing into them
+		 * instead of being copied. The views stay valid until the def is
+		 * destroyed. Must be set before the def is loaded; throws
+		 * std::logic_error afterwards.
+		 */
+		void setRetainStrings(bool retain);
+
+		// Loads the records now, unless they are already loaded.
+		void loadDef() const;
 
-		inline const std::vector<ESODatabaseRecord>& records() const { return m_records; }
-		inline std::vector<ESODatabaseRecord>& records() { return m_records; }
+		const std::vector<ESODatabaseRecord>& records() const;
+		std::vector<ESODatabaseRecord>& records();
 
 		const ESODatabaseRecord* findRecordById(uint64_t id) const;
 
 		inline const DatabaseDirectiveFile::Structure* structure() const { return m_def; }
 
 	private:
-		void parseStructureIntoRecord(esodata::SerializationStream& stream, const DatabaseDirectiveFile::Structure& structure, ESOFieldContainer& record);
+		using RecordReader = FastInputReader<true>;
+
+		struct LoadState;
+
+		LoadState& loadState() const;
 
-		void parseField(esodata::SerializationStream& stream, DatabaseDirectiveFile::FieldType type, ESODatabaseRecord::Value& value, const DatabaseDirectiveFile::StructureField& field);
+		void loadRecords() const;
+
+		void parseStructureIntoRecord(RecordReader& stream, const DatabaseDirectiveFile::Structure& structure, ESOFieldContainer& record) const;
+
+		void parseField(RecordReader& stream, DatabaseDirectiveFile::FieldType type, ESODatabaseRecord::Value& value, const DatabaseDirectiveFile::StructureField& field) const;
+
+		// Reserves space for a record of the given length in the retained blocks.
+		unsigned char* retainRecordStorage(size_t length) const;
 
 		const esodata::Filesystem* m_fs;
 		const DatabaseDirectiveFile::Structure* m_def;
 		const ESODatabaseParsingContext* m_parsingContext;
 		unsigned int m_id;
 		std::string m_name;
-		std::vector<ESODatabaseRecord> m_records;
-		std::unordered_map<uint64_t, const ESODatabaseRecord*> m_recordLookup;
+
+		/*
+		 * m_retainStrings is written under the lock of m_loadState, and the
+		 * rest is filled in by loadRecords under it. The state is kept behind
+		 * a pointer so that defs remain movable.
+		 */
+		bool m_retainStrings;
+		std::unique_ptr<LoadState> m_loadState;
+		mutable std::vector<ESODatabaseRecord> m_records;
+		mutable std::unordered_map<uint64_t, const ESODatabaseRecord*> m_recordLookup;
+		mutable std::vector<std::unique_ptr<unsigned char[]>> m_retainedBlocks;
+		mutable unsigned char* m_retainedBlockPosition;
+		mutable size_t m_retainedBlockRemaining;
 	};
 }
 
@@ -4,6 +4,7 @@
 #include <variant>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 
 #include <ESOData/Directives/DatabaseDirectiveFile.h>
 
@@ -36,7 +37,12 @@ namespace esodata {
 			std::variant<std::monostate, uint32_t, ValueForeignKey> data;
 		};
 
-		using Value = std::variant<std::monostate, long long, unsigned long long, ValueEnum, std::string, ValueArray, ValueForeignKey, bool, double, ValueAssetReference, ValueStruct, ValuePolymorphicReference>;
+		/*
+		 * String fields of defs loaded with retained strings are views into
+		 * the def's records rather than std::string; see
+		 * ESODatabaseDef::setRetainStrings.
+		 */
+		using Value = std::variant<std::monostate, long long, unsigned long long, ValueEnum, std::string, ValueArray, ValueForeignKey, bool, double, ValueAssetReference, ValueStruct, ValuePolymorphicReference, std::string_view>;
 
 		struct ValueArray {
 			std::vector<Value> values;
@@ -2,6 +2,7 @@
 #define ESODATA_DIRECTIVES_DIRECTIVE_FILE_H
 
 #include <filesystem>
+#include <vector>
 
 namespace esodata {
 	class DirectiveFile {
@@ -2,32 +2,119 @@
 #define ESODATA_FILESYSTEM_ARCHIVE_H
 
 #include <vector>
+#include <memory>
 #include <functional>
 #include <filesystem>
 
 #include <ESOData/Filesystem/MNFFile.h>
-
-#include <archiveparse/WindowsHandle.h>
-
-#include <Windows.h>
+#include <ESOData/Filesystem/ArchiveDataFile.h>
+#include <ESOData/Filesystem/FileView.h>
+#include <ESOData/Filesystem/FlatIndex.h>
 
 namespace esodata {
+	class SignatureVerifier;
+
+	/*
+	 * The manifest is only modified by the constructor; all const member
+	 * functions may be called concurrently. Entries returned by findEntry
+	 * and enumerateEntries live as long as the archive.
+	 */
 	class Archive {
 	public:
-		explicit Archive(const std::filesystem::path &manifestFilename, bool needPreciseSizes);
+		explicit Archive(const std::filesystem::path &manifestFilename, bool needPreciseSizes, ArchiveIOBackend backend = ArchiveIOBackend::Default,
+			bool useIndexSnapshot = false);
 		~Archive();
 
 		Archive(const Archive &other) = delete;
 		Archive &operator =(const Archive &other) = delete;
 
-		bool readFileByKey(uint64_t key, std::vector<unsigned char> &data);
-		void enumerateFiles(std::function<void(uint64_t key, size_t size)> &&enumerator);
+		inline const std::filesystem::path &manifestFilename() const {
+			return m_manifestFilename;
+		}
+
+		const ManifestFileEntry *findEntry(uint64_t key) const;
+		void enumerateEntries(std::function<void(uint64_t key, const ManifestFileEntry &entry)> &&enumerator) const;
+
+		void readEntry(uint64_t key, const ManifestFileEntry &entry, std::vector<unsigned char> &data) const;
+		void readEntry(uint64_t key, const ManifestFileEntry &entry, FileView &data) const;
+
+		/*
+		 * Decodes the entry directly into the specified buffer, which must be
+		 * at least entrySize(entry) bytes long. Returns the number of bytes
+		 * written, which may be less than entrySize(entry) for signed entries
+		 * if precise sizes were not requested, or couldn't be determined
+		 * because the entry's codec is unavailable.
+		 */
+		size_t readEntryInto(uint64_t key, const ManifestFileEntry &entry, unsigned char *data, size_t dataSize) const;
+
+		/*
+		 * Reads up to dataSize bytes of the entry's contents, starting at the
+		 * specified offset, and returns the number of bytes read. Stored
+		 * entries only read the requested extent, entries whose codec supports
+		 * range decoding are decoded up to the end of the range. Unless the
+		 * range covers the whole entry, the checksum cannot be verified for
+		 * these.
+		 */
+		size_t readEntryRange(uint64_t key, const ManifestFileEntry &entry, uint64_t offset, unsigned char *data, size_t dataSize) const;
+
+		size_t entrySize(const ManifestFileEntry &entry) const;
+
+		/*
+		 * Returns the stored bytes of the entry, as they are in the data file.
+		 * If the data file is memory-mapped, the view points into the mapping
+		 * and mapped is set.
+		 */
+		FileView readRawEntry(const ManifestFileEntry &entry, bool &mapped) const;
+
+		// Decodes the stored bytes of the entry, as returned by readRawEntry.
+		void decodeEntry(uint64_t key, const ManifestFileEntry &entry, const unsigned char *compressedData, std::vector<unsigned char> &data) const;
+
+		/*
+		 * Reads a batch of entries. Entries are sorted by data file and offset,
+		 * and extents that are close to each other are fetched with a single
+		 * read. Reads are submitted together through the data file's
+		 * readBatch, and fetched extents are decoded as they complete on the
+		 * worker pool shared with parallelFor. The callback is invoked from
+		 * the calling thread or the pool, one call at a time, in no
+		 * particular order.
+		 */
+		void readEntries(std::vector<std::pair<uint64_t, const ManifestFileEntry *>> &entries,
+			const std::function<void(uint64_t key, std::vector<unsigned char> &data)> &callback) const;
+
+		/*
+		 * Hints that the stored extents of the specified entries will be read
+		 * soon. Extents close to each other are merged, and each data file is
+		 * asked to start bringing them into memory. Doesn't wait for any I/O.
+		 */
+		void prefetchEntries(const std::vector<const ManifestFileEntry *> &entries) const;
+
+		bool readFileByKey(uint64_t key, std::vector<unsigned char> &data) const;
+
+		/*
+		 * Same as above, but stored (uncompressed, unsigned) entries are
+		 * returned as a view directly into the data file when the backend
+		 * supports it, without copying.
+		 */
+		bool readFileByKey(uint64_t key, FileView &data) const;
+
+		void enumerateFiles(std::function<void(uint64_t key, size_t size)> &&enumerator) const;
 
 	private:
+		const unsigned char *fetchCompressedData(const ManifestFileEntry &entry, unsigned char *destination) const;
+		void decodeEntryInto(uint64_t key, const ManifestFileEntry &entry, const unsigned char *compressedData, unsigned char *data) const;
+		void readDecodedRange(uint64_t key, const ManifestFileEntry &entry, uint64_t offset, unsigned char *data, size_t dataSize) const;
+		size_t signatureLength(uint64_t key, const ManifestFileEntry &entry) const;
+		const unsigned char *decodeSignedEntry(uint64_t key, const ManifestFileEntry &entry, const unsigned char *compressedData, size_t &size) const;
+		void verifyChecksum(uint64_t key, const ManifestFileEntry &entry, const unsigned char *data, size_t dataSize) const;
+		void checkChecksum(uint64_t key, const ManifestFileEntry &entry, uint32_t checksum) const;
+
+		std::filesystem::path m_manifestFilename;
+		bool m_preciseSizes;
 		MNFFile m_manifest;
-		std::vector<archiveparse::WindowsHandle> m_files;
+		FlatIndex<ManifestFileEntry> m_index;
+		std::vector<std::shared_ptr<ArchiveDataFile>> m_files;
+		std::unique_ptr<SignatureVerifier> m_signatureVerifier;
 	};
 }
 
 #endif
-
@@ -0,0 +1,75 @@
+#ifndef ESODATA_FILESYSTEM_ARCHIVE_DATA_FILE_H
+#define ESODATA_FILESYSTEM_ARCHIVE_DATA_FILE_H
+
+#include <stdint.h>
+
+#include <memory>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+namespace esodata {
+	enum class ArchiveIOBackend {
+		Default,
+		Synchronous,
+		MemoryMapped,
+
+		/*
+		 * Batched reads are submitted through io_uring, with many of them in
+		 * flight at once. Falls back to Synchronous where io_uring is not
+		 * available.
+		 */
+		IOUring
+	};
+
+	struct ArchiveReadRequest {
+		uint64_t offset;
+		unsigned char *data;
+		size_t size;
+	};
+
+	/*
+	 * One .dat file of an archive. Implementations provide positional reads,
+	 * and may additionally expose the file contents directly (mappedRegion),
+	 * in which case the returned pointer stays valid for the lifetime of the
+	 * object.
+	 *
+	 * Reads never depend on a shared file position, so read and mappedRegion
+	 * may be called concurrently from any number of threads.
+	 */
+	class ArchiveDataFile {
+	protected:
+		ArchiveDataFile();
+
+	public:
+		virtual ~ArchiveDataFile();
+
+		ArchiveDataFile(const ArchiveDataFile &other) = delete;
+		ArchiveDataFile &operator =(const ArchiveDataFile &other) = delete;
+
+		virtual void read(uint64_t offset, unsigned char *data, size_t size) const = 0;
+		virtual const unsigned char *mappedRegion(uint64_t offset, size_t size) const = 0;
+
+		/*
+		 * Performs all of the requested reads, invoking completion on the
+		 * calling thread with the index of each request as soon as its data
+		 * is available. The default implementation reads them one after
+		 * another; asynchronous backends keep them in flight together and
+		 * complete them in any order. If an exception is thrown, no reads
+		 * are outstanding by the time it propagates.
+		 */
+		virtual void readBatch(const std::vector<ArchiveReadRequest> &requests, const std::function<void(size_t index)> &completion) const;
+
+		/*
+		 * Hints that the specified extent will be read soon, so that the
+		 * backend may start bringing it into memory. Returns without waiting
+		 * for any I/O, and never fails: extents past the end of the file and
+		 * errors are ignored. The default implementation does nothing.
+		 */
+		virtual void prefetch(uint64_t offset, size_t size) const;
+
+		static std::shared_ptr<ArchiveDataFile> open(const std::filesystem::path &filename, ArchiveIOBackend backend);
+	};
+}
+
+#endif
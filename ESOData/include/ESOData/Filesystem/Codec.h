@@ -0,0 +1,120 @@
+#ifndef ESODATA_FILESYSTEM_CODEC_H
+#define ESODATA_FILESYSTEM_CODEC_H
+
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace esodata {
+	enum class CodecId : uint8_t {
+		Deflate,
+		Snappy,
+		Oodle,
+
+		Count
+	};
+
+	const char *codecName(CodecId id);
+
+	enum CodecCapabilities : uint32_t {
+		/*
+		 * decode() writes exactly outputSize bytes into the destination and
+		 * nothing past it, so entries can be decoded straight into the
+		 * caller's buffer. Other codecs decode into padded scratch storage.
+		 */
+		CodecDecodesIntoBuffer = 1 << 0,
+
+		// decodeRange() consumes its input in chunks, as it is read.
+		CodecSupportsStreaming = 1 << 1,
+
+		// decodeRange() can produce a part of the output without decoding all of it.
+		CodecSupportsRangeDecode = 1 << 2,
+	};
+
+	/*
+	 * Thrown when an entry needs a codec that is not registered or whose
+	 * library couldn't be loaded. Only the entry being read fails.
+	 */
+	class CodecUnavailableError : public std::runtime_error {
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	/*
+	 * Supplies the compressed data to decodeRange() in chunks. next() returns
+	 * the size of the next chunk, or 0 once the input is exhausted.
+	 */
+	class CodecInput {
+	protected:
+		~CodecInput() = default;
+
+	public:
+		virtual size_t next(const unsigned char *&data) = 0;
+	};
+
+	/*
+	 * Decoder for one compression format of archive entries. Codecs are
+	 * stateless and may be used from multiple threads at once.
+	 */
+	class Codec {
+	public:
+		virtual ~Codec();
+
+		virtual uint32_t capabilities() const = 0;
+
+		// Whether the codec can be used, e.g. whether its library is loaded.
+		virtual bool available() const;
+
+		virtual void decode(const unsigned char *input, size_t inputSize, unsigned char *output, size_t outputSize) const = 0;
+
+		/*
+		 * Same as decode, also returning the fileCRC32 of the output. Codecs
+		 * that produce their output progressively checksum it as it is
+		 * produced; by default, it is checksummed once decoding is done.
+		 */
+		virtual uint32_t decodeAndChecksum(const unsigned char *input, size_t inputSize, unsigned char *output, size_t outputSize) const;
+
+		/*
+		 * Produces outputSize bytes of decoded data, starting at offset. Only
+		 * supported if the codec has CodecSupportsRangeDecode.
+		 */
+		virtual void decodeRange(CodecInput &input, uint64_t offset, unsigned char *output, size_t outputSize) const;
+	};
+
+	/*
+	 * Process-wide set of codecs used to decode archive entries. The built-in
+	 * Deflate, Snappy and Oodle codecs are registered initially; registering
+	 * another codec under the same id replaces it, e.g. with a faster
+	 * implementation or an instrumented wrapper around find(id). Codecs that
+	 * were replaced stay alive, so lookups never need to lock.
+	 */
+	class CodecRegistry {
+	public:
+		static CodecRegistry &instance();
+
+		CodecRegistry(const CodecRegistry &other) = delete;
+		CodecRegistry &operator =(const CodecRegistry &other) = delete;
+
+		void registerCodec(CodecId id, std::shared_ptr<const Codec> codec);
+
+		const Codec *find(CodecId id) const;
+
+		// Same as find, but throws CodecUnavailableError unless the codec is usable.
+		const Codec &require(CodecId id) const;
+
+	private:
+		CodecRegistry();
+		~CodecRegistry();
+
+		std::mutex m_registrationMutex;
+		std::vector<std::shared_ptr<const Codec>> m_registered;
+		std::array<std::atomic<const Codec *>, static_cast<size_t>(CodecId::Count)> m_codecs;
+	};
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef ESODATA_FILESYSTEM_FILE_CACHE_H
+#define ESODATA_FILESYSTEM_FILE_CACHE_H
+
+#include <stdint.h>
+
+#include <memory>
+
+#include <ESOData/Filesystem/FileView.h>
+
+namespace esodata {
+	/*
+	 * Least-recently-used cache of file contents, bounded by a total byte
+	 * budget. The cache is split into independently locked shards, so it may
+	 * be used concurrently from any number of threads. Cached buffers are
+	 * shared with the callers and never modified.
+	 */
+	class FileCache {
+	public:
+		explicit FileCache(size_t byteBudget);
+		~FileCache();
+
+		FileCache(const FileCache &other) = delete;
+		FileCache &operator =(const FileCache &other) = delete;
+
+		inline size_t byteBudget() const {
+			return m_byteBudget;
+		}
+
+		bool find(uint64_t key, FileView &data);
+
+		// Files larger than the budget of a single shard are not cached.
+		void insert(uint64_t key, const FileView &data);
+
+		void clear();
+
+	private:
+		struct Shard;
+
+		static const size_t ShardCount = 16;
+
+		Shard &shardForKey(uint64_t key);
+
+		size_t m_byteBudget;
+		size_t m_shardBudget;
+		std::unique_ptr<Shard[]> m_shards;
+	};
+}
+
+#endif
@@ -16,6 +16,15 @@ namespace esodata {
 	SerializationStream &operator <<(SerializationStream &stream, const FileTableEntry &entry);
 	SerializationStream &operator >>(SerializationStream &stream, FileTableEntry &entry);
 
+	template<>
+	struct BulkSerializable<FileTableEntry> {
+		static constexpr bool value = true;
+		static constexpr size_t swapWidth = 0;
+		static constexpr bool floatingPoint = false;
+	};
+
+	static_assert(sizeof(FileTableEntry) == 16, "FileTableEntry must match its serialized form");
+
 	struct FileTableAdditionalData {
 		std::array<uint32_t, 11> unknown1;
 	};
@@ -23,6 +32,15 @@ namespace esodata {
 	SerializationStream &operator <<(SerializationStream &stream, const FileTableAdditionalData &entry);
 	SerializationStream &operator >>(SerializationStream &stream, FileTableAdditionalData &entry);
 
+	template<>
+	struct BulkSerializable<FileTableAdditionalData> {
+		static constexpr bool value = true;
+		static constexpr size_t swapWidth = sizeof(uint32_t);
+		static constexpr bool floatingPoint = false;
+	};
+
+	static_assert(sizeof(FileTableAdditionalData) == 44, "FileTableAdditionalData must match its serialized form");
+
 	struct FileTable {
 		uint16_t unknown1;
 		uint32_t unknown2;
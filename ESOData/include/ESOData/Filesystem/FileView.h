@@ -0,0 +1,42 @@
+#ifndef ESODATA_FILESYSTEM_FILE_VIEW_H
+#define ESODATA_FILESYSTEM_FILE_VIEW_H
+
+#include <vector>
+#include <memory>
+
+namespace esodata {
+	/*
+	 * Read-only view of file contents. The view either points directly into
+	 * storage kept alive by the owner (for example, a memory-mapped data file),
+	 * or owns a buffer of its own.
+	 */
+	class FileView {
+	public:
+		FileView() noexcept;
+		explicit FileView(std::vector<unsigned char> &&data);
+		FileView(const unsigned char *data, size_t size, std::shared_ptr<const void> owner) noexcept;
+		~FileView();
+
+		FileView(const FileView &other);
+		FileView &operator =(const FileView &other);
+
+		FileView(FileView &&other) noexcept;
+		FileView &operator =(FileView &&other) noexcept;
+
+		inline const unsigned char *data() const { return m_data; }
+		inline size_t size() const { return m_size; }
+		inline bool empty() const { return m_size == 0; }
+
+		inline const unsigned char *begin() const { return m_data; }
+		inline const unsigned char *end() const { return m_data + m_size; }
+
+		std::vector<unsigned char> toVector() const;
+
+	private:
+		std::shared_ptr<const void> m_owner;
+		const unsigned char *m_data;
+		size_t m_size;
+	};
+}
+
+#endif
@@ -7,10 +7,25 @@
 #include <functional>
 #include <filesystem>
 
+#include <ESOData/Filesystem/ArchiveDataFile.h>
+#include <ESOData/Filesystem/FileView.h>
+#include <ESOData/Filesystem/FlatIndex.h>
+
 namespace esodata {
 	class Archive;
 	struct FileTable;
+	struct ManifestFileEntry;
+	class FileCache;
 
+	/*
+	 * Filesystem is set up by a single thread: addManifest, loadFileTable and
+	 * the setters must not run concurrently with anything else. Once setup
+	 * is complete, the indexes are never modified again, and all const
+	 * member functions (reading, viewing and enumerating files) may be
+	 * called concurrently from any number of threads. Reads use positional
+	 * I/O and keep no per-call state in the Filesystem or its archives.
+	 * ESOData-checks/ConcurrentReadsCheck exercises this contract.
+	 */
 	class Filesystem {
 	public:
 		Filesystem();
@@ -19,6 +34,37 @@ namespace esodata {
 		Filesystem(const Filesystem &other) = delete;
 		Filesystem &operator =(const Filesystem &other) = delete;
 
+		inline ArchiveIOBackend archiveIOBackend() const {
+			return m_archiveIOBackend;
+		}
+
+		// Backend used for the archives of all manifests added afterwards.
+		inline void setArchiveIOBackend(ArchiveIOBackend backend) {
+			m_archiveIOBackend = backend;
+		}
+
+		/*
+		 * Enables caching of files read through readFileByKey and
+		 * viewFileByKey. Decoded files are kept within decodedBytes, and the
+		 * stored bytes of compressed files read from disk within
+		 * compressedBytes, so that re-decoding them doesn't touch the disk.
+		 * Zero disables the corresponding tier.
+		 */
+		void setCacheBudget(size_t decodedBytes, size_t compressedBytes);
+
+		inline bool indexSnapshotsEnabled() const {
+			return m_indexSnapshotsEnabled;
+		}
+
+		/*
+		 * When enabled, manifests and file tables added afterwards are loaded
+		 * from index snapshots kept next to the manifests when these are
+		 * current, and snapshots are written for them otherwise.
+		 */
+		inline void setIndexSnapshotsEnabled(bool enabled) {
+			m_indexSnapshotsEnabled = enabled;
+		}
+
 		void addManifest(const std::filesystem::path &filename, bool needPreciseSizes = true);
 
 		void loadFileTable(uint64_t fileTableKey);
@@ -26,11 +72,91 @@ namespace esodata {
 
 		bool tryReadFileByKey(uint64_t key, std::vector<unsigned char> &data) const;
 		std::vector<unsigned char> readFileByKey(uint64_t key) const;
+
+		/*
+		 * Reads all of the specified files, invoking the callback for each one
+		 * that exists. Keys that are not found are skipped. Reads are grouped
+		 * by archive and decoded in parallel, so the callback is not invoked in
+		 * the order of keys, and may be invoked from worker threads, although
+		 * never concurrently.
+		 */
+		void readFilesByKeys(const std::vector<uint64_t> &keys, std::function<void(uint64_t key, std::vector<unsigned char> &data)> &&callback) const;
+
+		/*
+		 * Hints that the specified files will be read soon, so that their
+		 * stored data can be brought into the page cache in the background.
+		 * Returns immediately, without waiting for any I/O, and never fails;
+		 * keys that are not found are skipped. Useful to warm up the next
+		 * working set (such as neighbouring world cells) ahead of use.
+		 */
+		void prefetch(const std::vector<uint64_t> &keys) const;
+
+		/*
+		 * Size of the buffer required by readFileInto. For signed manifests
+		 * added without precise sizes, this is an upper bound.
+		 */
+		size_t fileSize(uint64_t key) const;
+
+		/*
+		 * Decodes the file directly into the specified buffer, which must be
+		 * at least fileSize(key) bytes long, and returns the size of the file.
+		 */
+		size_t readFileInto(uint64_t key, unsigned char *data, size_t dataSize) const;
+
+		/*
+		 * Reads up to dataSize bytes of the file, starting at the specified
+		 * offset, without decoding the rest of it when possible. Returns the
+		 * number of bytes read, which is less than dataSize if the range
+		 * extends past the end of the file. Checksums are only verified if the
+		 * range covers the whole file.
+		 */
+		size_t readRange(uint64_t key, uint64_t offset, unsigned char *data, size_t dataSize) const;
+
+		/*
+		 * Returns the first size bytes of the file, or all of it if it is
+		 * shorter, for looking at headers and magic numbers. Deflate, Snappy
+		 * and stored files are only decoded up to that point, and, as with
+		 * readRange, checksums are not verified unless the whole file is read.
+		 */
+		std::vector<unsigned char> peekFile(uint64_t key, size_t size) const;
+
+		/*
+		 * Reads and verifies (checksum and, for signed manifests, signature)
+		 * all of the specified files, spreading the work across all cores.
+		 * Returns the keys of the files that failed verification or could not
+		 * be read. Keys that are not found are skipped.
+		 */
+		std::vector<uint64_t> verifyFiles(const std::vector<uint64_t> &keys) const;
+
+		bool tryViewFileByKey(uint64_t key, FileView &data) const;
+		FileView viewFileByKey(uint64_t key) const;
+
 		void enumerateFiles(std::function<void(uint64_t key, size_t size)> &&enumerator) const;
 
 	private:
+		struct FileLocation {
+			const Archive *archive;
+			const ManifestFileEntry *entry;
+		};
+
+		const FileLocation *findFile(uint64_t key) const;
+		std::vector<const FileLocation *> findFiles(const std::vector<uint64_t> &keys) const;
+		const FileLocation &findExistingFile(uint64_t key) const;
+		void readCachedFile(uint64_t key, const FileLocation &location, FileView &data) const;
+
+		ArchiveIOBackend m_archiveIOBackend;
+		bool m_indexSnapshotsEnabled;
 		std::vector<std::unique_ptr<Archive>> m_archives;
 		std::vector<std::unique_ptr<FileTable>> m_fileTables;
+
+		/*
+		 * Merged index of all mounted manifests. When a key is present in
+		 * several manifests, the one added first takes precedence.
+		 */
+		FlatIndex<FileLocation> m_index;
+
+		std::unique_ptr<FileCache> m_decodedCache;
+		std::unique_ptr<FileCache> m_compressedCache;
 	};
 }
 
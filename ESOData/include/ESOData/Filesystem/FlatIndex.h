@@ -0,0 +1,365 @@
+#ifndef ESODATA_FILESYSTEM_FLAT_INDEX_H
+#define ESODATA_FILESYSTEM_FLAT_INDEX_H
+
+#include <ESOData/Serialization/SerializationStream.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace esodata {
+	/*
+	 * In-memory lookup index keyed by 64-bit file keys, built from the
+	 * on-disk hash tables once they are loaded. Keys and values share a
+	 * slot, slots live in a single power-of-two array probed linearly, and
+	 * buckets are chosen by an integer mixer instead of hashing the key
+	 * bytes, so most lookups touch a single cache line.
+	 *
+	 * Values are stored by copy and pointers to them stay valid until the
+	 * next insertion. The index is built by a single thread; afterwards,
+	 * the const member functions may be called concurrently.
+	 *
+	 * The slot array can be written out as is and read back in place from
+	 * memory that outlives the index, such as a mapped file, instead of
+	 * being rebuilt. The first insertion into such an index copies the
+	 * slots.
+	 */
+	template<typename Value>
+	class FlatIndex {
+		static_assert(std::is_trivially_copyable<Value>::value, "flat index values must be trivially copyable");
+
+	public:
+		FlatIndex() : m_count(0), m_shift(64), m_hasEmptyKey(false), m_emptyKeySlot(), m_mappedSlots(nullptr), m_mappedCapacity(0) {
+
+		}
+
+		inline size_t size() const {
+			return m_count;
+		}
+
+		void reserve(size_t count) {
+			detach();
+
+			if (count > maxCountForCapacity(m_slots.size()))
+				rehash(capacityForCount(count));
+		}
+
+		/*
+		 * Inserts the value unless the key is already present, in which case
+		 * the existing value is kept. Returns whether the value was inserted.
+		 */
+		bool insert(uint64_t key, const Value &value) {
+			detach();
+
+			if (key == EmptyKey) {
+				if (m_hasEmptyKey)
+					return false;
+
+				m_hasEmptyKey = true;
+				m_emptyKeySlot = Slot{ key, value };
+				m_count++;
+
+				return true;
+			}
+
+			if (m_count + 1 > maxCountForCapacity(m_slots.size()))
+				rehash(capacityForCount(m_count + 1));
+
+			auto mask = m_slots.size() - 1;
+			for (auto index = bucket(key);; index = (index + 1) & mask) {
+				auto &slot = m_slots[index];
+				if (slot.key == key)
+					return false;
+
+				if (slot.key == EmptyKey) {
+					slot = Slot{ key, value };
+					m_count++;
+
+					return true;
+				}
+			}
+		}
+
+		const Value *find(uint64_t key) const {
+			if (key == EmptyKey)
+				return m_hasEmptyKey ? &m_emptyKeySlot.value : nullptr;
+
+			if (capacity() == 0)
+				return nullptr;
+
+			auto slots = slotData();
+			auto mask = capacity() - 1;
+			for (auto index = bucket(key);; index = (index + 1) & mask) {
+				const auto &slot = slots[index];
+				if (slot.key == key)
+					return &slot.value;
+
+				if (slot.key == EmptyKey)
+					return nullptr;
+			}
+		}
+
+		/*
+		 * Looks up count keys, storing a pointer to the value of each one, or
+		 * null if it is not present, in results. The home slots of a group of
+		 * keys are prefetched before any of them is probed, so that the cache
+		 * misses of independent lookups overlap.
+		 */
+		void findMany(const uint64_t *keys, size_t count, const Value **results) const {
+			if (capacity() == 0) {
+				for (size_t index = 0; index < count; index++) {
+					results[index] = find(keys[index]);
+				}
+
+				return;
+			}
+
+			auto slots = slotData();
+			for (size_t groupStart = 0; groupStart < count; groupStart += FindManyGroupSize) {
+				auto groupSize = count - groupStart < FindManyGroupSize ? count - groupStart : FindManyGroupSize;
+
+				for (size_t index = 0; index < groupSize; index++) {
+					prefetchSlot(&slots[bucket(keys[groupStart + index])]);
+				}
+
+				for (size_t index = 0; index < groupSize; index++) {
+					results[groupStart + index] = find(keys[groupStart + index]);
+				}
+			}
+		}
+
+		template<typename Enumerator>
+		void enumerate(Enumerator &&enumerator) const {
+			if (m_hasEmptyKey)
+				enumerator(m_emptyKeySlot.key, m_emptyKeySlot.value);
+
+			auto slots = slotData();
+			for (size_t index = 0, count = capacity(); index < count; index++) {
+				if (slots[index].key != EmptyKey)
+					enumerator(slots[index].key, slots[index].value);
+			}
+		}
+
+		/*
+		 * The slots are written in native byte order, aligned relative to
+		 * the start of the stream, so that readRaw can use them in place.
+		 * The layout depends on how keys are placed; changing it must
+		 * invalidate anything written by earlier code.
+		 */
+		void writeRaw(SerializationStream &stream) const {
+			stream
+				<< static_cast<uint64_t>(m_count)
+				<< static_cast<uint64_t>(capacity())
+				<< static_cast<uint32_t>(m_shift)
+				<< static_cast<uint8_t>(m_hasEmptyKey);
+
+			stream.writeData(reinterpret_cast<const unsigned char *>(&m_emptyKeySlot), sizeof(Slot));
+
+			std::vector<unsigned char> padding(slotPadding(stream.getCurrentPosition()));
+			stream.writeData(padding.data(), padding.size());
+
+			stream.writeData(reinterpret_cast<const unsigned char *>(slotData()), capacity() * sizeof(Slot));
+		}
+
+		/*
+		 * Reads an index written by writeRaw. If owner is not null, it keeps
+		 * the memory the stream reads from alive, and the slots are used from
+		 * there without copying when they are suitably aligned. Throws
+		 * std::logic_error if the data doesn't describe a valid index; the
+		 * slot array is scanned for that, but not rehashed.
+		 */
+		void readRaw(SerializationStream &stream, const std::shared_ptr<const void> &owner) {
+			uint64_t count, capacity;
+			uint32_t shift;
+			uint8_t hasEmptyKey;
+			Slot emptyKeySlot;
+
+			stream >> count >> capacity >> shift >> hasEmptyKey;
+			stream.readData(reinterpret_cast<unsigned char *>(&emptyKeySlot), sizeof(Slot));
+
+			if (capacity != 0 && (capacity < 16 || (capacity & (capacity - 1)) != 0 || capacity > std::numeric_limits<size_t>::max() / sizeof(Slot)))
+				throw std::logic_error("bad capacity in flat index");
+
+			if (shift != shiftForCapacity(static_cast<size_t>(capacity)))
+				throw std::logic_error("bad shift in flat index");
+
+			if (hasEmptyKey > 1 || (hasEmptyKey && emptyKeySlot.key != EmptyKey))
+				throw std::logic_error("bad empty key slot in flat index");
+
+			if (count > maxCountForCapacity(static_cast<size_t>(capacity)) + hasEmptyKey)
+				throw std::logic_error("too many entries in flat index");
+
+			stream.getRegionForRead(slotPadding(stream.getCurrentPosition()));
+
+			auto bytes = stream.getRegionForRead(static_cast<size_t>(capacity) * sizeof(Slot));
+			auto slots = reinterpret_cast<const Slot *>(bytes);
+			bool inPlace = owner && reinterpret_cast<uintptr_t>(bytes) % alignof(Slot) == 0;
+
+			std::vector<Slot> ownSlots;
+			if (!inPlace) {
+				ownSlots.resize(static_cast<size_t>(capacity));
+				if (capacity != 0)
+					memcpy(ownSlots.data(), bytes, static_cast<size_t>(capacity) * sizeof(Slot));
+
+				slots = ownSlots.data();
+			}
+
+			/*
+			 * Lookups stop at the first empty slot, so they only terminate if
+			 * the occupancy is as recorded.
+			 */
+			uint64_t occupied = 0;
+			for (size_t index = 0; index < capacity; index++) {
+				if (slots[index].key != EmptyKey)
+					occupied++;
+			}
+
+			if (occupied + hasEmptyKey != count)
+				throw std::logic_error("entry count doesn't match in flat index");
+
+			m_slots = std::move(ownSlots);
+			m_count = static_cast<size_t>(count);
+			m_shift = shift;
+			m_hasEmptyKey = hasEmptyKey != 0;
+			m_emptyKeySlot = emptyKeySlot;
+
+			if (inPlace) {
+				m_mappedSlots = slots;
+				m_mappedCapacity = static_cast<size_t>(capacity);
+				m_mappedOwner = owner;
+			}
+			else {
+				m_mappedSlots = nullptr;
+				m_mappedCapacity = 0;
+				m_mappedOwner.reset();
+			}
+		}
+
+	private:
+		/*
+		 * Slots are aligned to their power-of-two size when it is no larger
+		 * than a cache line, so that no slot straddles two lines.
+		 */
+		static constexpr size_t slotAlignment() {
+			size_t size = sizeof(uint64_t) + sizeof(Value);
+			if (size <= 64 && (size & (size - 1)) == 0)
+				return size;
+
+			return alignof(uint64_t) > alignof(Value) ? alignof(uint64_t) : alignof(Value);
+		}
+
+		struct alignas(slotAlignment()) Slot {
+			uint64_t key;
+			Value value;
+		};
+
+		// Marks unused slots. An entry with this key is kept aside.
+		static constexpr uint64_t EmptyKey = ~static_cast<uint64_t>(0);
+
+		static constexpr size_t FindManyGroupSize = 16;
+
+		// Tables are kept at most three quarters full.
+		static size_t maxCountForCapacity(size_t capacity) {
+			return capacity - capacity / 4;
+		}
+
+		static size_t capacityForCount(size_t count) {
+			size_t capacity = 16;
+			while (maxCountForCapacity(capacity) < count)
+				capacity *= 2;
+
+			return capacity;
+		}
+
+		static unsigned int shiftForCapacity(size_t capacity) {
+			unsigned int shift = 64;
+			for (auto remaining = capacity; remaining > 1; remaining >>= 1)
+				shift--;
+
+			return shift;
+		}
+
+		static size_t slotPadding(size_t position) {
+			return (alignof(Slot) - position % alignof(Slot)) % alignof(Slot);
+		}
+
+		inline size_t bucket(uint64_t key) const {
+			key ^= key >> 33;
+			key *= 0xFF51AFD7ED558CCDULL;
+			key ^= key >> 29;
+
+			return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> m_shift);
+		}
+
+		static inline void prefetchSlot(const Slot *slot) {
+#ifdef _MSC_VER
+			_mm_prefetch(reinterpret_cast<const char *>(slot), _MM_HINT_T0);
+#else
+			__builtin_prefetch(slot);
+#endif
+		}
+
+		void rehash(size_t capacity) {
+			std::vector<Slot> slots(capacity, Slot{ EmptyKey, Value() });
+
+			std::swap(m_slots, slots);
+			m_shift = shiftForCapacity(capacity);
+
+			auto mask = m_slots.size() - 1;
+			for (const auto &slot : slots) {
+				if (slot.key == EmptyKey)
+					continue;
+
+				auto index = bucket(slot.key);
+				while (m_slots[index].key != EmptyKey)
+					index = (index + 1) & mask;
+
+				m_slots[index] = slot;
+			}
+		}
+
+		/*
+		 * Slots read in place are used while m_mappedOwner is set; this keeps
+		 * moved-from indexes, which lose the owner, empty.
+		 */
+		inline const Slot *slotData() const {
+			return m_mappedOwner ? m_mappedSlots : m_slots.data();
+		}
+
+		inline size_t capacity() const {
+			return m_mappedOwner ? m_mappedCapacity : m_slots.size();
+		}
+
+		void detach() {
+			if (!m_mappedOwner)
+				return;
+
+			m_slots.assign(m_mappedSlots, m_mappedSlots + m_mappedCapacity);
+			m_mappedSlots = nullptr;
+			m_mappedCapacity = 0;
+			m_mappedOwner.reset();
+		}
+
+		std::vector<Slot> m_slots;
+		size_t m_count;
+		unsigned int m_shift;
+		bool m_hasEmptyKey;
+		Slot m_emptyKeySlot;
+		const Slot *m_mappedSlots;
+		size_t m_mappedCapacity;
+		std::shared_ptr<const void> m_mappedOwner;
+	};
+}
+
+#endif
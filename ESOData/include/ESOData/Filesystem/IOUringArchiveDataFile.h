@@ -0,0 +1,32 @@
+#ifndef ESODATA_FILESYSTEM_IO_URING_ARCHIVE_DATA_FILE_H
+#define ESODATA_FILESYSTEM_IO_URING_ARCHIVE_DATA_FILE_H
+
+#include <ESOData/Filesystem/ArchiveDataFile.h>
+
+namespace esodata {
+	/*
+	 * Data file read through io_uring on Linux. Single reads are plain
+	 * positional reads; batches get a ring of their own, with the file and
+	 * the destination buffers registered with it, so concurrent batches
+	 * don't contend.
+	 */
+	class IOUringArchiveDataFile final : public ArchiveDataFile {
+	public:
+		explicit IOUringArchiveDataFile(const std::filesystem::path &filename);
+		~IOUringArchiveDataFile() override;
+
+		void read(uint64_t offset, unsigned char *data, size_t size) const override;
+		const unsigned char *mappedRegion(uint64_t offset, size_t size) const override;
+		void prefetch(uint64_t offset, size_t size) const override;
+
+		void readBatch(const std::vector<ArchiveReadRequest> &requests, const std::function<void(size_t index)> &completion) const override;
+
+		// Whether the kernel supports io_uring and the process may use it.
+		static bool isSupported();
+
+	private:
+		int m_fd;
+	};
+}
+
+#endif
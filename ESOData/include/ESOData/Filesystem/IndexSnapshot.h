@@ -0,0 +1,67 @@
+#ifndef ESODATA_FILESYSTEM_INDEX_SNAPSHOT_H
+#define ESODATA_FILESYSTEM_INDEX_SNAPSHOT_H
+
+#include <stdint.h>
+
+#include <filesystem>
+#include <vector>
+
+namespace esodata {
+	struct MNFFile;
+	struct FileTable;
+	struct ManifestFileEntry;
+
+	template<typename Value>
+	class FlatIndex;
+
+	/*
+	 * Index snapshots cache parsed manifests and file tables next to the
+	 * manifests, so that later runs can load them without inflating and
+	 * parsing them again. Snapshots hold the tables as laid out in memory, in
+	 * native byte order, behind a versioned header carrying a CRC32 of the
+	 * rest. A snapshot that doesn't match the running code or its source
+	 * exactly, or that is damaged, is ignored.
+	 *
+	 * Reading functions return false if the snapshot is missing, stale or
+	 * unusable. Writing is best effort: failures are ignored, since the
+	 * snapshot is only an optimization.
+	 */
+
+	// Identifies the exact manifest contents a snapshot was built from.
+	struct IndexSnapshotStamp {
+		uint64_t manifestSize;
+		int64_t manifestModificationTime;
+		uint32_t manifestCRC32;
+
+		static IndexSnapshotStamp ofManifest(const std::filesystem::path &manifestFilename, const std::vector<unsigned char> &manifestData);
+	};
+
+	bool operator ==(const IndexSnapshotStamp &a, const IndexSnapshotStamp &b);
+	bool operator !=(const IndexSnapshotStamp &a, const IndexSnapshotStamp &b);
+
+	std::filesystem::path manifestSnapshotFilename(const std::filesystem::path &manifestFilename);
+	std::filesystem::path fileTableSnapshotFilename(const std::filesystem::path &manifestFilename, uint64_t fileTableKey);
+
+	/*
+	 * Manifest snapshots hold the manifest header and the flat index of its
+	 * files, with the slot array stored as laid out in memory. When the
+	 * snapshot is mapped, the index uses the slots from the mapping, which
+	 * it keeps alive, so loading doesn't copy or rehash the entries. The
+	 * hash table of the manifest body is left empty.
+	 *
+	 * Manifest snapshots record whether they carry precise sizes of signed
+	 * files; one without them is not used when precise sizes are requested.
+	 * When reading fails, manifest and index may be partially filled in.
+	 */
+	bool readManifestSnapshot(const std::filesystem::path &filename, const IndexSnapshotStamp &stamp, bool needPreciseSizes, MNFFile &manifest, FlatIndex<ManifestFileEntry> &index);
+	void writeManifestSnapshot(const std::filesystem::path &filename, const IndexSnapshotStamp &stamp, bool preciseSizes, const MNFFile &manifest, const FlatIndex<ManifestFileEntry> &index);
+
+	/*
+	 * File table snapshots are validated against the manifest entry of the
+	 * file table they were built from.
+	 */
+	bool readFileTableSnapshot(const std::filesystem::path &filename, const ManifestFileEntry &source, FileTable &table);
+	void writeFileTableSnapshot(const std::filesystem::path &filename, const ManifestFileEntry &source, const FileTable &table);
+}
+
+#endif
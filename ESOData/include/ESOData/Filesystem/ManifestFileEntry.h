@@ -2,6 +2,9 @@
 #define ESODATA_FILESYSTEM_MANIFEST_FILE_ENTRY_H
 
 #include <stdint.h>
+#include <stddef.h>
+
+#include <vector>
 
 namespace esodata {
 	class SerializationStream;
@@ -21,11 +24,18 @@ namespace esodata {
 		uint8_t archiveIndex;
 		uint16_t unknown;
 
-		size_t cachedSize;
+		// Entries are stored by sizes that fit in 32 bits, so the cached size does too.
+		uint32_t cachedSize;
 	};
 
 	SerializationStream &operator <<(SerializationStream &stream, const ManifestFileEntry &entry);
 	SerializationStream &operator >>(SerializationStream &stream, ManifestFileEntry &entry);
+
+	/*
+	 * Entries are laid out differently in memory, so arrays of them are
+	 * parsed from a single region instead of field by field.
+	 */
+	SerializationStream &operator >>(SerializationStream &stream, std::vector<ManifestFileEntry> &entries);
 }
 
 #endif
@@ -0,0 +1,22 @@
+#ifndef ESODATA_FILESYSTEM_MAPPED_ARCHIVE_DATA_FILE_H
+#define ESODATA_FILESYSTEM_MAPPED_ARCHIVE_DATA_FILE_H
+
+#include <ESOData/Filesystem/ArchiveDataFile.h>
+
+namespace esodata {
+	class MappedArchiveDataFile final : public ArchiveDataFile {
+	public:
+		explicit MappedArchiveDataFile(const std::filesystem::path &filename);
+		~MappedArchiveDataFile() override;
+
+		void read(uint64_t offset, unsigned char *data, size_t size) const override;
+		const unsigned char *mappedRegion(uint64_t offset, size_t size) const override;
+		void prefetch(uint64_t offset, size_t size) const override;
+
+	private:
+		const unsigned char *m_data;
+		size_t m_size;
+	};
+}
+
+#endif
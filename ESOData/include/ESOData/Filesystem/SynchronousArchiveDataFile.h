@@ -0,0 +1,29 @@
+#ifndef ESODATA_FILESYSTEM_SYNCHRONOUS_ARCHIVE_DATA_FILE_H
+#define ESODATA_FILESYSTEM_SYNCHRONOUS_ARCHIVE_DATA_FILE_H
+
+#include <ESOData/Filesystem/ArchiveDataFile.h>
+
+#ifdef _WIN32
+#include <archiveparse/WindowsHandle.h>
+#endif
+
+namespace esodata {
+	class SynchronousArchiveDataFile final : public ArchiveDataFile {
+	public:
+		explicit SynchronousArchiveDataFile(const std::filesystem::path &filename);
+		~SynchronousArchiveDataFile() override;
+
+		void read(uint64_t offset, unsigned char *data, size_t size) const override;
+		const unsigned char *mappedRegion(uint64_t offset, size_t size) const override;
+		void prefetch(uint64_t offset, size_t size) const override;
+
+	private:
+#ifdef _WIN32
+		archiveparse::WindowsHandle m_handle;
+#else
+		int m_fd;
+#endif
+	};
+}
+
+#endif
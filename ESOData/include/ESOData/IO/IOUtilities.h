@@ -7,6 +7,12 @@
 
 namespace esodata {
 	std::vector<unsigned char> readWholeFile(const std::filesystem::path &filename);
+
+	/*
+	 * Writes the file under a temporary name first and renames it into place,
+	 * so that readers never observe a partially written file.
+	 */
+	void writeWholeFileAtomically(const std::filesystem::path &filename, const std::vector<unsigned char> &data);
 }
 
 #endif
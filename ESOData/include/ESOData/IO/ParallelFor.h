@@ -0,0 +1,18 @@
+#ifndef ESODATA_IO_PARALLEL_FOR_H
+#define ESODATA_IO_PARALLEL_FOR_H
+
+#include <functional>
+
+namespace esodata {
+	/*
+	 * Invokes body for every index in [0, count), spreading the calls across
+	 * all cores through a pool of worker threads shared by the process. The
+	 * calling thread participates, so calls may be nested: when the pool is
+	 * busy, the caller processes the indices by itself. If any invocation
+	 * throws, remaining indices are skipped and the first exception is
+	 * rethrown once all workers have stopped.
+	 */
+	void parallelFor(size_t count, const std::function<void(size_t index)> &body);
+}
+
+#endif
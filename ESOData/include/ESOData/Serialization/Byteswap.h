@@ -0,0 +1,77 @@
+#ifndef ESODATA_SERIALIZATION_BYTESWAP_H
+#define ESODATA_SERIALIZATION_BYTESWAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <type_traits>
+
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
+
+namespace esodata {
+	inline uint16_t byteswap16(uint16_t value) {
+#ifdef _MSC_VER
+		return _byteswap_ushort(value);
+#else
+		return __builtin_bswap16(value);
+#endif
+	}
+
+	inline uint32_t byteswap32(uint32_t value) {
+#ifdef _MSC_VER
+		return _byteswap_ulong(value);
+#else
+		return __builtin_bswap32(value);
+#endif
+	}
+
+	inline uint64_t byteswap64(uint64_t value) {
+#ifdef _MSC_VER
+		return _byteswap_uint64(value);
+#else
+		return __builtin_bswap64(value);
+#endif
+	}
+
+	// Reverses the byte order of any trivially copyable scalar.
+	template<typename T>
+	inline T byteswapValue(T value) {
+		static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be byteswapped");
+
+		if constexpr (sizeof(T) == 2) {
+			uint16_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			bits = byteswap16(bits);
+			memcpy(&value, &bits, sizeof(bits));
+		}
+		else if constexpr (sizeof(T) == 4) {
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			bits = byteswap32(bits);
+			memcpy(&value, &bits, sizeof(bits));
+		}
+		else if constexpr (sizeof(T) == 8) {
+			uint64_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			bits = byteswap64(bits);
+			memcpy(&value, &bits, sizeof(bits));
+		}
+		else {
+			static_assert(sizeof(T) == 1, "unsupported scalar size");
+		}
+
+		return value;
+	}
+
+	/*
+	 * Reverses the byte order of every width-byte scalar in the buffer, in
+	 * place. dataSize must be a multiple of width; the buffer doesn't need to
+	 * be aligned.
+	 */
+	void byteswapArray(unsigned char *data, size_t dataSize, size_t width);
+}
+
+#endif
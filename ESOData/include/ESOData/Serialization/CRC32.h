@@ -0,0 +1,32 @@
+#ifndef ESODATA_SERIALIZATION_CRC32_H
+#define ESODATA_SERIALIZATION_CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace esodata {
+	/*
+	 * CRC-32 (reflected polynomial 0xEDB88320), as computed by zlib's crc32:
+	 * the register is inverted on entry and exit, so results can be chained
+	 * the same way. Uses carry-less multiplication folding when the CPU
+	 * supports it, and slice-by-8 tables otherwise.
+	 */
+	uint32_t crc32Update(uint32_t crc, const unsigned char *data, size_t dataSize);
+
+	// Same as crc32Update, but always with the slice-by-8 tables.
+	uint32_t crc32UpdatePortable(uint32_t crc, const unsigned char *data, size_t dataSize);
+
+	// Whether crc32Update uses carry-less multiplication folding on this CPU.
+	bool crc32UsesFolding();
+
+	/*
+	 * Checksum stored in manifest entries. It is the same CRC-32, but
+	 * without the inversions, that is, ~crc32(0xffffffff, data).
+	 */
+	uint32_t fileCRC32(const unsigned char *data, size_t dataSize);
+
+	// Continues a fileCRC32 checksum over data that follows.
+	uint32_t fileCRC32Update(uint32_t checksum, const unsigned char *data, size_t dataSize);
+}
+
+#endif
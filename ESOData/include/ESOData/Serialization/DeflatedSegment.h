@@ -5,13 +5,27 @@
 #include <ESOData/Serialization/InputSerializationStream.h>
 #include <ESOData/Serialization/OutputSerializationStream.h>
 #include <ESOData/Serialization/SizedSegment.h>
+#include <ESOData/Serialization/ScratchBuffer.h>
+#include <ESOData/Serialization/Byteswap.h>
+
+#include <functional>
 
 namespace esodata {
 	class SerializationStream;
 
 	std::vector<unsigned char> zlibCompress(const unsigned char *inputData, size_t inputLength);
+
+	/*
+	 * Compresses into a caller-provided buffer of at least
+	 * zlibCompressBound(inputLength) bytes, returning the compressed length.
+	 */
+	size_t zlibCompressBound(size_t inputLength);
+	size_t zlibCompress(const unsigned char *inputData, size_t inputLength, unsigned char *outputData, size_t outputLength);
 	void zlibUncompress(const unsigned char *inputData, size_t inputLength, unsigned char *outputData, size_t outputLength);
 
+	// Same as zlibUncompress, also returning the fileCRC32 of the output.
+	uint32_t zlibUncompressAndChecksum(const unsigned char *inputData, size_t inputLength, unsigned char *outputData, size_t outputLength);
+
 	template<typename T, ByteswapMode Mode = ByteswapMode::Keep>
 	struct DeflatedSegment {
 		DeflatedSegment(T &data) : data(data) {
@@ -33,7 +47,8 @@ namespace esodata {
 
 	template<typename T, ByteswapMode Mode>
 	SerializationStream &operator <<(SerializationStream &stream, const DeflatedSegment<T, Mode> &segment) {
-		OutputSerializationStream nestedStream;
+		ScratchBuffer uncompressedBuffer;
+		OutputSerializationStream nestedStream(std::move(uncompressedBuffer.storage()));
 
 		if constexpr (Mode == ByteswapMode::Keep) {
 			nestedStream.setSwapEndian(stream.swapEndian());
@@ -47,46 +62,132 @@ namespace esodata {
 
 		nestedStream << segment.data;
 
-		auto &&uncompressedData = std::move(nestedStream.data());
+		auto &uncompressedData = uncompressedBuffer.storage();
+		uncompressedData = std::move(nestedStream.data());
 
-		auto compressedData = zlibCompress(uncompressedData.data(), uncompressedData.size());
+		auto compressedBound = zlibCompressBound(uncompressedData.size());
+
+		ScratchBuffer compressedBuffer;
+		auto compressedData = compressedBuffer.data(compressedBound);
+		auto compressedSize = zlibCompress(uncompressedData.data(), uncompressedData.size(), compressedData, compressedBound);
 
 		uint32_t uncompressedLength = static_cast<uint32_t>(uncompressedData.size());
-		uint32_t compressedLength = static_cast<uint32_t>(compressedData.size());
+		uint32_t compressedLength = static_cast<uint32_t>(compressedSize);
 
-		stream << uncompressedLength << compressedLength << compressedData;
+		stream << uncompressedLength << compressedLength;
+		stream.writeData(compressedData, compressedSize);
 
 		return stream;
 	}
 
-	template<typename T, ByteswapMode Mode>
-	SerializationStream &operator >>(SerializationStream &stream, DeflatedSegment<T, Mode> &segment) {
-		uint32_t uncompressedLength;
-		uint32_t compressedLength;
+	template<typename T>
+	void readDeflatedDataThroughStream(const unsigned char *compressedData, size_t compressedLength, size_t uncompressedLength, bool swapEndian, T &data) {
+		ScratchBuffer uncompressedBuffer;
+		auto uncompressedData = uncompressedBuffer.data(uncompressedLength);
 
-		stream >> uncompressedLength >> compressedLength;
+		zlibUncompress(compressedData, compressedLength, uncompressedData, uncompressedLength);
 
-		auto compressedData = stream.getRegionForRead(compressedLength);
-		std::vector<unsigned char> uncompressedData(uncompressedLength);
+		InputSerializationStream nestedStream(uncompressedData, uncompressedData + uncompressedLength);
+		nestedStream.setSwapEndian(swapEndian);
+		nestedStream >> data;
+	}
+
+	/*
+	 * Decodes the data of a deflated segment whose compressed bytes were
+	 * already located.
+	 */
+	template<typename T>
+	void readDeflatedData(const unsigned char *compressedData, size_t compressedLength, size_t uncompressedLength, bool swapEndian, T &data) {
+		readDeflatedDataThroughStream(compressedData, compressedLength, uncompressedLength, swapEndian, data);
+	}
+
+	/*
+	 * Vectors of plain scalars that fill the whole segment are decompressed
+	 * straight into their storage.
+	 */
+	template<typename T>
+	void readDeflatedData(const unsigned char *compressedData, size_t compressedLength, size_t uncompressedLength, bool swapEndian, std::vector<T> &data) {
+		if constexpr (BulkSerializable<T>::value) {
+			bool swap = swapEndian != BulkSerializable<T>::floatingPoint;
+
+			if (uncompressedLength == data.size() * sizeof(T) && (!swap || BulkSerializable<T>::swapWidth != 0)) {
+				auto bytes = reinterpret_cast<unsigned char *>(data.data());
 
-		zlibUncompress(compressedData, compressedLength, uncompressedData.data(), uncompressedData.size());
+				zlibUncompress(compressedData, compressedLength, bytes, uncompressedLength);
 
-		InputSerializationStream nestedStream(uncompressedData.data(), uncompressedData.data() + uncompressedData.size());
+				if (swap)
+					byteswapArray(bytes, uncompressedLength, BulkSerializable<T>::swapWidth);
+
+				return;
+			}
+		}
+
+		readDeflatedDataThroughStream(compressedData, compressedLength, uncompressedLength, swapEndian, data);
+	}
 
+	template<ByteswapMode Mode>
+	bool deflatedSegmentSwapEndian(const SerializationStream &stream) {
 		if constexpr (Mode == ByteswapMode::Keep) {
-			nestedStream.setSwapEndian(stream.swapEndian());
+			return stream.swapEndian();
 		}
 		else if constexpr (Mode == ByteswapMode::Enable) {
-			nestedStream.setSwapEndian(true);
+			return true;
 		}
 		else {
-			nestedStream.setSwapEndian(false);
+			return false;
 		}
+	}
 
-		nestedStream >> segment.data;
+	template<typename T, ByteswapMode Mode>
+	SerializationStream &operator >>(SerializationStream &stream, const DeflatedSegment<T, Mode> &segment) {
+		uint32_t uncompressedLength;
+		uint32_t compressedLength;
+
+		stream >> uncompressedLength >> compressedLength;
+
+		auto compressedData = stream.getRegionForRead(compressedLength);
+
+		readDeflatedData(compressedData, compressedLength, uncompressedLength, deflatedSegmentSwapEndian<Mode>(stream), segment.data);
 
 		return stream;
 	}
+
+	/*
+	 * Deflated segments that are located in a stream first and decoded
+	 * later, all of them concurrently. The compressed data is referenced in
+	 * place, so it has to stay valid until decode returns; the destination
+	 * of each segment may not be touched in between.
+	 */
+	class DeflatedSegmentBatch {
+	public:
+		DeflatedSegmentBatch();
+		~DeflatedSegmentBatch();
+
+		DeflatedSegmentBatch(const DeflatedSegmentBatch &other) = delete;
+		DeflatedSegmentBatch &operator =(const DeflatedSegmentBatch &other) = delete;
+
+		template<typename T, ByteswapMode Mode>
+		void add(SerializationStream &stream, const DeflatedSegment<T, Mode> &segment) {
+			uint32_t uncompressedLength;
+			uint32_t compressedLength;
+
+			stream >> uncompressedLength >> compressedLength;
+
+			auto compressedData = stream.getRegionForRead(compressedLength);
+			auto swapEndian = deflatedSegmentSwapEndian<Mode>(stream);
+			auto &data = segment.data;
+
+			m_segments.emplace_back([compressedData, compressedLength, uncompressedLength, swapEndian, &data]() {
+				readDeflatedData(compressedData, compressedLength, uncompressedLength, swapEndian, data);
+			});
+		}
+
+		// Decodes all segments added so far, rethrowing the first failure.
+		void decode();
+
+	private:
+		std::vector<std::function<void()>> m_segments;
+	};
 }
 
 #endif
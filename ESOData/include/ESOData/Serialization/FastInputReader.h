@@ -0,0 +1,212 @@
+#ifndef ESODATA_SERIALIZATION_FAST_INPUT_READER_H
+#define ESODATA_SERIALIZATION_FAST_INPUT_READER_H
+
+#include <ESOData/Serialization/InputSerializationStream.h>
+#include <ESOData/Serialization/SizedVector.h>
+#include <ESOData/Serialization/Byteswap.h>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+
+#include <string.h>
+
+namespace esodata {
+	template<typename T>
+	struct IsFastInputScalar : std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value> {
+
+	};
+
+	/*
+	 * Decodes a scalar with the conventions of SerializationStream: integers
+	 * and enums are swapped when SwapEndian is set, floating-point values when
+	 * it is not, and booleans are any non-zero byte.
+	 */
+	template<bool SwapEndian, typename T>
+	inline T loadScalar(const unsigned char *data) {
+		static_assert(IsFastInputScalar<T>::value, "only scalars can be loaded directly");
+
+		if constexpr (std::is_same<T, bool>::value) {
+			return *data != 0;
+		}
+		else {
+			T value;
+			memcpy(&value, data, sizeof(value));
+
+			constexpr bool swap = std::is_floating_point<T>::value ? !SwapEndian : SwapEndian;
+			if constexpr (swap && sizeof(T) > 1)
+				value = byteswapValue(value);
+
+			return value;
+		}
+	}
+
+	/*
+	 * Reads the fields of a structure whose extent was already checked by
+	 * FastInputReader::fields, without checking each of them again.
+	 */
+	template<bool SwapEndian>
+	class FastInputCursor {
+	public:
+		explicit FastInputCursor(const unsigned char *data) : m_ptr(data) {
+
+		}
+
+		template<typename T>
+		FastInputCursor &operator >>(T &value) {
+			value = loadScalar<SwapEndian, T>(m_ptr);
+			m_ptr += sizeof(T);
+
+			return *this;
+		}
+
+	private:
+		const unsigned char *m_ptr;
+	};
+
+	/*
+	 * Non-virtual counterpart of InputSerializationStream for hot parsing
+	 * paths. The byte order is fixed at compile time, and reads bump a
+	 * pointer after a single bounds check; fields() checks once for a whole
+	 * fixed-size structure. Types that only have SerializationStream
+	 * operators are read through an InputSerializationStream over the
+	 * remaining data, so the existing overload set keeps working.
+	 */
+	template<bool SwapEndian>
+	class FastInputReader {
+	public:
+		FastInputReader(const unsigned char *begin, const unsigned char *end) : m_begin(begin), m_end(end), m_ptr(begin) {
+
+		}
+
+		inline size_t position() const {
+			return static_cast<size_t>(m_ptr - m_begin);
+		}
+
+		inline size_t remaining() const {
+			return static_cast<size_t>(m_end - m_ptr);
+		}
+
+		const unsigned char *readRegion(size_t size) {
+			if (size > remaining())
+				throw std::logic_error("read is out of bounds");
+
+			auto ptr = m_ptr;
+			m_ptr += size;
+
+			return ptr;
+		}
+
+		/*
+		 * Consumes count structures of size bytes each, returning a cursor
+		 * over them.
+		 */
+		FastInputCursor<SwapEndian> fields(size_t size, size_t count = 1) {
+			if (count != 0 && size > remaining() / count)
+				throw std::logic_error("read is out of bounds");
+
+			return FastInputCursor<SwapEndian>(readRegion(size * count));
+		}
+
+		template<typename T>
+		FastInputReader &operator >>(T &value) {
+			if constexpr (IsFastInputScalar<T>::value) {
+				value = loadScalar<SwapEndian, T>(readRegion(sizeof(T)));
+			}
+			else {
+				readThroughStream(value);
+			}
+
+			return *this;
+		}
+
+		FastInputReader &operator >>(std::string &value) {
+			uint16_t length;
+			*this >> length;
+
+			auto region = readRegion(static_cast<size_t>(length) + 1);
+			value.assign(reinterpret_cast<const char *>(region), length);
+
+			return *this;
+		}
+
+		// Reads a string as a view into the underlying data, without copying it.
+		FastInputReader &operator >>(std::string_view &value) {
+			uint16_t length;
+			*this >> length;
+
+			auto region = readRegion(static_cast<size_t>(length) + 1);
+			value = std::string_view(reinterpret_cast<const char *>(region), length);
+
+			return *this;
+		}
+
+		template<typename T>
+		FastInputReader &operator >>(std::vector<T> &value) {
+			if constexpr (std::is_same<T, bool>::value)
+				readThroughStream(value);
+			else
+				readArray(value.data(), value.size());
+
+			return *this;
+		}
+
+		template<typename T, size_t N>
+		FastInputReader &operator >>(std::array<T, N> &value) {
+			readArray(value.data(), value.size());
+
+			return *this;
+		}
+
+		template<typename Size, typename Data>
+		FastInputReader &operator >>(const SizedVector<Size, Data> &vector) {
+			Size length;
+			*this >> length;
+
+			vector.data.resize(length);
+
+			return *this >> vector.data;
+		}
+
+	private:
+		template<typename T>
+		void readArray(T *data, size_t count) {
+			if constexpr (BulkSerializable<T>::value) {
+				constexpr bool swap = SwapEndian != BulkSerializable<T>::floatingPoint;
+
+				if constexpr (!swap || BulkSerializable<T>::swapWidth != 0) {
+					if (count != 0 && sizeof(T) > remaining() / count)
+						throw std::logic_error("read is out of bounds");
+
+					if (count != 0) {
+						memcpy(data, readRegion(count * sizeof(T)), count * sizeof(T));
+						byteswapArray(reinterpret_cast<unsigned char *>(data), count * sizeof(T), swap ? BulkSerializable<T>::swapWidth : 0);
+					}
+
+					return;
+				}
+			}
+
+			for (size_t index = 0; index < count; index++) {
+				*this >> data[index];
+			}
+		}
+
+		template<typename T>
+		void readThroughStream(T &value) {
+			InputSerializationStream stream(m_ptr, m_end);
+			stream.setSwapEndian(SwapEndian);
+			stream >> value;
+
+			m_ptr += stream.getCurrentPosition();
+		}
+
+		const unsigned char *m_begin;
+		const unsigned char *m_end;
+		const unsigned char *m_ptr;
+	};
+}
+
+#endif
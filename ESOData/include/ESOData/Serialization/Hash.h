@@ -2,6 +2,7 @@
 #define ESODATA_SERIALIZATION_HASH_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 namespace esodata {
 	uint32_t hashDataJenkins(const unsigned char *data, size_t dataSize);
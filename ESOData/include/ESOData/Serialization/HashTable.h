@@ -7,8 +7,11 @@
 
 #include <vector>
 #include <algorithm>
+#include <limits>
 #include <stdexcept>
 
+#include <string.h>
+
 namespace esodata {
 	
 	template<typename Key, typename Value>
@@ -37,8 +40,12 @@ namespace esodata {
 		return stream;
 	}
 
+	/*
+	 * Reads the table header and locates its segments, leaving them to be
+	 * decoded by the batch, possibly along with segments of other tables.
+	 */
 	template<typename Key, typename Value>
-	SerializationStream &operator >>(SerializationStream &stream, HashTableType3Data<Key, Value> &data) {
+	void readHashTableData(SerializationStream &stream, HashTableType3Data<Key, Value> &data, DeflatedSegmentBatch &batch) {
 		uint32_t countLength;
 		stream >> countLength;
 
@@ -58,17 +65,50 @@ namespace esodata {
 		data.values.resize(pairCount);
 
 		if(hashTableCount != 0)
-			stream >> makeDeflatedSegment<std::vector<uint32_t>, ByteswapMode::Disable>(data.hashTable);
+			batch.add(stream, makeDeflatedSegment<std::vector<uint32_t>, ByteswapMode::Disable>(data.hashTable));
 
 		if(pairCount != 0)
-			stream >> makeDeflatedSegment<std::vector<Key>, ByteswapMode::Disable>(data.keys);
+			batch.add(stream, makeDeflatedSegment<std::vector<Key>, ByteswapMode::Disable>(data.keys));
 
 		if(pairCount != 0)
-			stream >> makeDeflatedSegment<std::vector<Value>, ByteswapMode::Disable>(data.values);
+			batch.add(stream, makeDeflatedSegment<std::vector<Value>, ByteswapMode::Disable>(data.values));
+	}
+
+	template<typename Key, typename Value>
+	SerializationStream &operator >>(SerializationStream &stream, HashTableType3Data<Key, Value> &data) {
+		DeflatedSegmentBatch batch;
+		readHashTableData(stream, data, batch);
+		batch.decode();
 
 		return stream;
 	}
 
+	template<typename T>
+	void writeRawVector(SerializationStream &stream, const std::vector<T> &data) {
+		static_assert(std::is_trivially_copyable<T>::value, "raw vectors must be trivially copyable");
+
+		stream << static_cast<uint64_t>(data.size());
+		stream.writeData(reinterpret_cast<const unsigned char *>(data.data()), data.size() * sizeof(T));
+	}
+
+	template<typename T>
+	void readRawVector(SerializationStream &stream, std::vector<T> &data) {
+		static_assert(std::is_trivially_copyable<T>::value, "raw vectors must be trivially copyable");
+
+		uint64_t size;
+		stream >> size;
+
+		// The region read below is bounded by the stream, as long as its size doesn't wrap.
+		if (size > std::numeric_limits<size_t>::max() / sizeof(T))
+			throw std::logic_error("raw vector is too large");
+
+		auto bytes = stream.getRegionForRead(static_cast<size_t>(size) * sizeof(T));
+
+		data.resize(static_cast<size_t>(size));
+		if (!data.empty())
+			memcpy(data.data(), bytes, data.size() * sizeof(T));
+	}
+
 	template<typename Key, typename Value>
 	class HashTable {
 	public:
@@ -165,20 +205,50 @@ namespace esodata {
 			return end();
 		}
 
+		/*
+		 * Writes and reads the table as laid out in memory, without compression
+		 * or byte swapping. Only suitable for caches local to this machine.
+		 */
+		void writeRaw(SerializationStream &stream) const {
+			writeRawVector(stream, type3Data.hashTable);
+			writeRawVector(stream, type3Data.keys);
+			writeRawVector(stream, type3Data.values);
+		}
+
+		void readRaw(SerializationStream &stream) {
+			readRawVector(stream, type3Data.hashTable);
+			readRawVector(stream, type3Data.keys);
+			readRawVector(stream, type3Data.values);
+
+			if (type3Data.keys.size() != type3Data.values.size())
+				throw std::logic_error("key and value counts don't match in hash table");
+
+			for (auto entry : type3Data.hashTable) {
+				if ((entry & 0xC0000000U) == 0x80000000U && (entry & 0x3FFFFFFFU) >= type3Data.keys.size())
+					throw std::logic_error("pair index is out of bounds in hash table");
+			}
+		}
+
 	private:		
 		HashTableType3Data<Key, Value> type3Data;
 
-		friend SerializationStream &operator >> (SerializationStream &serializer, HashTable<Key, Value> &hashTable) {
+		friend void readHashTable(SerializationStream &serializer, HashTable<Key, Value> &hashTable, DeflatedSegmentBatch &batch) {
 			uint16_t tableType;
 			serializer >> tableType;
 
 			switch (tableType) {
 			case 3:
-				serializer >> hashTable.type3Data;
+				readHashTableData(serializer, hashTable.type3Data, batch);
 				break;
 			default:
 				throw std::runtime_error("unsupported hash table type");
 			}
+		}
+
+		friend SerializationStream &operator >> (SerializationStream &serializer, HashTable<Key, Value> &hashTable) {
+			DeflatedSegmentBatch batch;
+			readHashTable(serializer, hashTable, batch);
+			batch.decode();
 
 			return serializer;
 		}
@@ -0,0 +1,24 @@
+#ifndef ESODATA_SERIALIZATION_INFLATE_H
+#define ESODATA_SERIALIZATION_INFLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace esodata {
+	/*
+	 * Decodes a complete zlib stream whose decoded size is known in advance,
+	 * in a single pass over the input and without any per-call setup. The
+	 * stream must decode to exactly outputLength bytes and consume all of the
+	 * input. Returns false if the stream is malformed, or uses something this
+	 * decoder leaves to zlib (preset dictionaries, incomplete Huffman codes);
+	 * zlibUncompress then retries with zlib, which remains the reference.
+	 *
+	 * The output is checksummed one block at a time, right after the block
+	 * is decoded and while it is still in cache. If outputChecksum is given,
+	 * the fileCRC32 of the output is computed in the same pass and stored
+	 * there.
+	 */
+	bool inflateWholeBuffer(const unsigned char *inputData, size_t inputLength, unsigned char *outputData, size_t outputLength, uint32_t *outputChecksum = nullptr);
+}
+
+#endif
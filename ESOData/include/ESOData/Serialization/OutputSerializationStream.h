@@ -10,6 +10,9 @@ namespace esodata {
 	public:
 		OutputSerializationStream();
 		explicit OutputSerializationStream(SerializationStream *otherStream);
+
+		// Writes into the given buffer, reusing its capacity. Its contents are discarded.
+		explicit OutputSerializationStream(std::vector<unsigned char> &&buffer);
 		~OutputSerializationStream();
 
 		virtual unsigned char *getRegionForWrite(size_t size) override;
@@ -0,0 +1,38 @@
+#ifndef ESODATA_SERIALIZATION_SCRATCH_BUFFER_H
+#define ESODATA_SERIALIZATION_SCRATCH_BUFFER_H
+
+#include <vector>
+
+#include <stddef.h>
+
+namespace esodata {
+	/*
+	 * Transient byte buffer borrowed from a pool kept by each thread, for
+	 * data that only lives while one segment or row is being processed.
+	 * Buffers go back to the pool when released, keeping their capacity, so
+	 * a long run of segments only allocates as many buffers as are nested at
+	 * once. Buffers that grew unusually large are freed instead.
+	 */
+	class ScratchBuffer {
+	public:
+		ScratchBuffer();
+		~ScratchBuffer();
+
+		ScratchBuffer(const ScratchBuffer &other) = delete;
+		ScratchBuffer &operator =(const ScratchBuffer &other) = delete;
+
+		/*
+		 * Returns storage for at least size bytes with unspecified contents,
+		 * valid until the next call or until the buffer is released.
+		 */
+		unsigned char *data(size_t size);
+
+		// The underlying vector, for users that manage its size themselves.
+		inline std::vector<unsigned char> &storage() { return m_storage; }
+
+	private:
+		std::vector<unsigned char> m_storage;
+	};
+}
+
+#endif
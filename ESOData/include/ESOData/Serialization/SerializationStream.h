@@ -5,6 +5,7 @@
 
 #include <type_traits>
 #include <vector>
+#include <array>
 #include <string>
 
 namespace esodata {
@@ -34,6 +35,13 @@ namespace esodata {
 		void writeData(const unsigned char *data, size_t dataSize);
 		void readData(unsigned char *data, size_t dataSize);
 
+		/*
+		 * Transfers a block of scalars at once, reversing the byte order of
+		 * each swapWidth-byte scalar. Zero doesn't swap anything.
+		 */
+		void writeBlock(const unsigned char *data, size_t dataSize, size_t swapWidth);
+		void readBlock(unsigned char *data, size_t dataSize, size_t swapWidth);
+
 		virtual unsigned char *getRegionForWrite(size_t size) = 0;
 		virtual const unsigned char *getRegionForRead(size_t size) = 0;
 
@@ -70,7 +78,7 @@ namespace esodata {
 
 	template<typename T>
 	typename std::enable_if<std::is_enum<T>::value, SerializationStream &>::type operator <<(SerializationStream &stream, T value) {
-		return stream << static_cast<std::underlying_type<T>::type>(value);
+		return stream << static_cast<typename std::underlying_type<T>::type>(value);
 	}
 	
 	template<typename T>
@@ -81,8 +89,74 @@ namespace esodata {
 		return stream;
 	}
 
+	/*
+	 * Element types that vectors and arrays transfer as a single block,
+	 * because their serialized form is their in-memory representation up to
+	 * byte order. swapWidth is the width of the scalars that byte swapping
+	 * applies to, or zero if they are of different widths, in which case the
+	 * block path is only taken when nothing needs swapping. Floating-point
+	 * values are swapped under the opposite condition, as in readFloat.
+	 *
+	 * Aggregates opt in by specializing this template, provided that they
+	 * are serialized as all of their fields in declaration order, without
+	 * padding, and their scalars share the same swapping condition.
+	 */
+	template<typename T, typename Enable = void>
+	struct BulkSerializable {
+		static constexpr bool value = false;
+	};
+
+	template<typename T>
+	struct BulkSerializable<T, typename std::enable_if<(std::is_integral<T>::value && !std::is_same<T, bool>::value) || std::is_enum<T>::value>::type> {
+		static constexpr bool value = true;
+		static constexpr size_t swapWidth = sizeof(T);
+		static constexpr bool floatingPoint = false;
+	};
+
+	template<typename T>
+	struct BulkSerializable<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+		static constexpr bool value = true;
+		static constexpr size_t swapWidth = sizeof(T);
+		static constexpr bool floatingPoint = true;
+	};
+
+	/*
+	 * Returns false, leaving the stream untouched, if the elements have to
+	 * be swapped but have no uniform swap width.
+	 */
+	template<typename T>
+	bool writeBulk(SerializationStream &stream, const T *data, size_t count) {
+		static_assert(std::is_trivially_copyable<T>::value, "bulk-serialized types must be trivially copyable");
+
+		bool swap = stream.swapEndian() != BulkSerializable<T>::floatingPoint;
+		if (swap && BulkSerializable<T>::swapWidth == 0)
+			return false;
+
+		stream.writeBlock(reinterpret_cast<const unsigned char *>(data), count * sizeof(T), swap ? BulkSerializable<T>::swapWidth : 0);
+
+		return true;
+	}
+
+	template<typename T>
+	bool readBulk(SerializationStream &stream, T *data, size_t count) {
+		static_assert(std::is_trivially_copyable<T>::value, "bulk-serialized types must be trivially copyable");
+
+		bool swap = stream.swapEndian() != BulkSerializable<T>::floatingPoint;
+		if (swap && BulkSerializable<T>::swapWidth == 0)
+			return false;
+
+		stream.readBlock(reinterpret_cast<unsigned char *>(data), count * sizeof(T), swap ? BulkSerializable<T>::swapWidth : 0);
+
+		return true;
+	}
+
 	template<typename T>
 	SerializationStream &operator <<(SerializationStream &stream, const std::vector<T> &value) {
+		if constexpr (BulkSerializable<T>::value) {
+			if (writeBulk(stream, value.data(), value.size()))
+				return stream;
+		}
+
 		for (const auto &entry : value) {
 			stream << entry;
 		}
@@ -95,6 +169,11 @@ namespace esodata {
 
 	template<typename T>
 	SerializationStream &operator >>(SerializationStream &stream, std::vector<T> &value) {
+		if constexpr (BulkSerializable<T>::value) {
+			if (readBulk(stream, value.data(), value.size()))
+				return stream;
+		}
+
 		for (auto &entry : value) {
 			stream >> entry;
 		}
@@ -107,6 +186,11 @@ namespace esodata {
 
 	template<typename T, size_t N>
 	SerializationStream &operator <<(SerializationStream &stream, const std::array<T, N> &value) {
+		if constexpr (BulkSerializable<T>::value) {
+			if (writeBulk(stream, value.data(), value.size()))
+				return stream;
+		}
+
 		for (auto &entry : value) {
 			stream << entry;
 		}
@@ -116,6 +200,11 @@ namespace esodata {
 
 	template<typename T, size_t N>
 	SerializationStream &operator >>(SerializationStream &stream, std::array<T, N> &value) {
+		if constexpr (BulkSerializable<T>::value) {
+			if (readBulk(stream, value.data(), value.size()))
+				return stream;
+		}
+
 		for (auto &entry : value) {
 			stream >> entry;
 		}
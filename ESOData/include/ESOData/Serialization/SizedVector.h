@@ -20,7 +20,7 @@ namespace esodata {
 	}
 
 	template<typename Size, typename Data>
-	SerializationStream &operator >>(SerializationStream &stream, SizedVector<Size, Data> &vector) {
+	SerializationStream &operator >>(SerializationStream &stream, const SizedVector<Size, Data> &vector) {
 		Size length;
 		stream >> length;
 		vector.data.resize(length);
@@ -671,20 +671,26 @@ HRESULT CALLBACK ProjectedFilesystem::getFileData(const PRJ_CALLBACK_DATA *callb
 	}
 
 	try {
-		auto data = this_->m_fs.readFileByKey(id);
+		auto fileSize = this_->m_fs.fileSize(id);
 
 		size_t realLength;
-		if (byteOffset > data.size())
+		if (byteOffset > fileSize)
 			realLength = 0;
 		else {
-			realLength = std::min<size_t>(length, data.size() - byteOffset);
+			realLength = std::min<size_t>(length, fileSize - byteOffset);
 		}
 
 		auto buffer = PrjAllocateAlignedBuffer(callbackData->NamespaceVirtualizationContext, realLength);
 		if (buffer == nullptr)
 			return HRESULT_FROM_WIN32(ERROR_OUTOFMEMORY);
 
-		memcpy(buffer, data.data() + byteOffset, realLength);
+		try {
+			realLength = this_->m_fs.readRange(id, byteOffset, static_cast<unsigned char *>(buffer), realLength);
+		}
+		catch (...) {
+			PrjFreeAlignedBuffer(buffer);
+			throw;
+		}
 
 		auto hr = PrjWriteFileData(callbackData->NamespaceVirtualizationContext, &callbackData->DataStreamId, buffer, byteOffset, realLength);
 